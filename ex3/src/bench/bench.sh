@@ -0,0 +1,67 @@
+#!/bin/bash
+# Runs the bundled algorithms over the ex3/inputs corpus and over generated houses of increasing size and MaxSteps,
+# and writes one row per (case, house, algorithm) to a CSV file that can be diffed between commits.
+#
+# Environment:
+#   BENCH_SIZES      side lengths of the generated square houses (default: "100 1000 10000")
+#   BENCH_MAX_STEPS  MaxSteps values of the generated houses (default: "1000 100000 10000000")
+#   BENCH_OUT        result file (default: bench/bench_results.csv)
+#   BENCH_LEGACY     set to 1 to also run the ex1 and ex2 algorithms (legacy_ex1, legacy_ex2) next to A and B
+
+set -e
+
+SRC_DIR=$(cd "$(dirname "$0")/.." && pwd)
+INPUTS_DIR=$(cd "$SRC_DIR/../inputs" && pwd)
+MYROBOT="$SRC_DIR/simulator/myrobot"
+GEN_HOUSES="$SRC_DIR/house_generator/gen_houses"
+SIZES=${BENCH_SIZES:-"100 1000 10000"}
+MAX_STEPS=${BENCH_MAX_STEPS:-"1000 100000 10000000"}
+OUT=${BENCH_OUT:-"$SRC_DIR/bench/bench_results.csv"}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# myrobot loads every .so in a single directory
+mkdir -p "$WORK_DIR/algorithms"
+cp "$SRC_DIR"/algorithm_A/*.so "$SRC_DIR"/algorithm_B/*.so "$WORK_DIR/algorithms/"
+if [ "$BENCH_LEGACY" = 1 ]; then
+    cp "$SRC_DIR"/legacy_ex1/*.so "$SRC_DIR"/legacy_ex2/*.so "$WORK_DIR/algorithms/"
+fi
+
+# prints the value of a "Key = value" line from the header of a house file
+house_param() {
+    sed -n "2,5s/^$2 *= *\([0-9]*\)$/\1/p" "$1"
+}
+
+# runs myrobot on a directory of houses and appends its metrics rows, prefixed by the case name, to rows.csv
+run_case() {
+    local case_name=$1 house_dir=$2 run_dir="$WORK_DIR/run_$1"
+    mkdir -p "$run_dir"
+    (cd "$run_dir" && "$MYROBOT" -house_path="$house_dir" -algo_path="$WORK_DIR/algorithms" -num_threads=1 -summary_only -metrics_out=metrics.csv > /dev/null)
+    tail -n +2 "$run_dir/metrics.csv" | while IFS=, read -r house rest; do
+        local house_file="$house_dir/$house.house"
+        local cells=$(( $(house_param "$house_file" Rows) * $(house_param "$house_file" Cols) ))
+        echo "$case_name,$house,$cells,$(house_param "$house_file" MaxSteps),$rest"
+    done >> "$WORK_DIR/rows.csv"
+    echo "$case_name done" >&2
+}
+
+: > "$WORK_DIR/rows.csv"
+run_case corpus "$INPUTS_DIR"
+
+for size in $SIZES; do
+    for steps in $MAX_STEPS; do
+        case_name="gen_${size}_${steps}"
+        # same seed for every case, so a case's house is identical between commits
+        "$GEN_HOUSES" -out="$WORK_DIR/$case_name" -prefix="$case_name" -seed=1 -size="$size" -max_steps="$steps" -topology=rooms
+        run_case "$case_name" "$WORK_DIR/$case_name"
+    done
+done
+
+{
+    # the metrics columns after the house, as myrobot names them
+    echo "case,house,cells,max_steps,$(head -n 1 "$WORK_DIR/run_corpus/metrics.csv" | cut -d, -f2-)"
+    sort -t, -k1,1 -k2,2 -k5,5 "$WORK_DIR/rows.csv"
+} > "$OUT"
+
+echo "Benchmark results written to $OUT"
@@ -0,0 +1,121 @@
+#!/bin/bash
+# Runs the bundled algorithms over a fixed, seeded set of generated houses and compares the results with bench/perfcheck_baseline.csv:
+# the simulated steps per second, the 99th percentile of a step's time, the algorithm's peak heap memory and the score of every
+# (house, algorithm) pair. Exits with 1, printing the pairs and metrics that got worse than the baseline by more than the tolerance.
+# Every run is repeated and the best speed and latency of the repeats are compared, to keep noise out.
+# The speed and latency only mean something on the host that wrote the baseline (its CPU model and number of CPUs are recorded
+# in the baseline's first line), on any other host they're skipped with a warning and only the memory and scores are compared.
+#
+# Environment:
+#   PERFCHECK_TOLERANCE         allowed regression of steps_per_sec and step_p99_ns, in percent (default: 25)
+#   PERFCHECK_MEMORY_TOLERANCE  allowed regression of algo_peak_bytes, in percent (default: 10)
+#   PERFCHECK_SCORE_TOLERANCE   allowed regression of the score, in percent (default: 0, the scores are deterministic)
+#   PERFCHECK_RUNS              repeats of the batch (default: 5)
+#   PERFCHECK_UPDATE            set to 1 to write the results as the new baseline instead of comparing
+#   PERFCHECK_BASELINE          baseline file (default: bench/perfcheck_baseline.csv)
+
+set -e
+
+SRC_DIR=$(cd "$(dirname "$0")/.." && pwd)
+MYROBOT="$SRC_DIR/simulator/myrobot"
+GEN_HOUSES="$SRC_DIR/house_generator/gen_houses"
+TOLERANCE=${PERFCHECK_TOLERANCE:-25}
+MEMORY_TOLERANCE=${PERFCHECK_MEMORY_TOLERANCE:-10}
+SCORE_TOLERANCE=${PERFCHECK_SCORE_TOLERANCE:-0}
+RUNS=${PERFCHECK_RUNS:-5}
+BASELINE=${PERFCHECK_BASELINE:-"$SRC_DIR/bench/perfcheck_baseline.csv"}
+HOST="# host: $(grep -m1 '^model name' /proc/cpuinfo | cut -d: -f2 | sed 's/^ *//'), $(nproc) cpus"
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+mkdir -p "$WORK_DIR/algorithms"
+cp "$SRC_DIR"/algorithm_A/*.so "$SRC_DIR"/algorithm_B/*.so "$WORK_DIR/algorithms/"
+
+# changing the house set (or the seeds) needs a new baseline
+"$GEN_HOUSES" -out="$WORK_DIR/houses" -prefix=perf -count=4 -seed=1 -size=30 -max_steps=5000 -topology=rooms
+"$GEN_HOUSES" -out="$WORK_DIR/houses" -prefix=perf_maze -count=2 -seed=1 -size=30 -max_steps=5000 -topology=maze
+
+for run in $(seq 1 "$RUNS"); do
+    mkdir -p "$WORK_DIR/run_$run"
+    (cd "$WORK_DIR/run_$run" && "$MYROBOT" -house_path="$WORK_DIR/houses" -algo_path="$WORK_DIR/algorithms" -num_threads=1 -seed=1 \
+        -summary_only -profile_steps -metrics_out=metrics.csv > /dev/null)
+done
+
+# the best of the runs per pair, with the metrics' columns found by name
+awk -F, '
+    FNR == 1 { for (i = 1; i <= NF; i++) column[$i] = i; next }
+    {
+        pair = $column["house"] "," $column["algorithm"]
+        speed = $column["steps_per_sec"]; p99 = $column["step_p99_ns"]
+        if (!(pair in score)) { score[pair] = $column["score"]; memory[pair] = $column["algo_peak_bytes"]; best_speed[pair] = speed; best_p99[pair] = p99 }
+        if (speed > best_speed[pair]) best_speed[pair] = speed
+        if (p99 < best_p99[pair]) best_p99[pair] = p99
+    }
+    END {
+        print "house,algorithm,score,steps_per_sec,step_p99_ns,algo_peak_bytes"
+        for (pair in score) print pair "," score[pair] "," best_speed[pair] "," best_p99[pair] "," memory[pair] | "sort"
+    }
+' "$WORK_DIR"/run_*/metrics.csv > "$WORK_DIR/results.csv"
+
+if [ "$PERFCHECK_UPDATE" = 1 ]; then
+    { echo "$HOST"; cat "$WORK_DIR/results.csv"; } > "$BASELINE"
+    echo "Baseline written to $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "No baseline at $BASELINE, create it with PERFCHECK_UPDATE=1" >&2
+    exit 1
+fi
+
+CHECK_TIMING=1
+BASELINE_HOST=$(head -n 1 "$BASELINE")
+if [ "$BASELINE_HOST" != "$HOST" ]; then
+    case "$BASELINE_HOST" in
+        "# host: "*) BASELINE_HOST=${BASELINE_HOST#"# host: "} ;;
+        *) BASELINE_HOST="not recorded" ;;
+    esac
+    echo "warning: the baseline was written on another host ($BASELINE_HOST, this one is ${HOST#"# host: "}), skipping steps_per_sec and step_p99_ns" >&2
+    CHECK_TIMING=0
+fi
+
+# a pair missing from either side fails as well, the house set and the baseline must match
+awk -F, -v check_timing="$CHECK_TIMING" -v tolerance="$TOLERANCE" -v memory_tolerance="$MEMORY_TOLERANCE" -v score_tolerance="$SCORE_TOLERANCE" '
+    # direction is 1 where higher is worse, -1 where lower is worse
+    function check(pair, metric, direction, allowed, base, current,    change) {
+        change = base == 0 ? (current == 0 ? 0 : 100) : (current - base) * 100 / base
+        # compared as printed: the p99 is the bound of a histogram bucket, and two buckets can be exactly 25% apart
+        change = sprintf("%.1f", change) + 0
+        if (change * direction > allowed) {
+            rows[++failed] = sprintf("%-12s %-30s %-16s %14s %14s %+9.1f%%", substr(pair, 1, index(pair, ",") - 1), substr(pair, index(pair, ",") + 1), metric, base, current, change)
+        }
+    }
+    /^#/ || $1 == "house" { next }
+    NR == FNR { baseline[$1 "," $2] = $0; next }
+    {
+        pair = $1 "," $2
+        if (!(pair in baseline)) { missing[++missing_count] = pair " is not in the baseline"; next }
+        split(baseline[pair], base, ",")
+        check(pair, "score", 1, score_tolerance, base[3], $3)
+        if (check_timing) {
+            check(pair, "steps_per_sec", -1, tolerance, base[4], $4)
+            check(pair, "step_p99_ns", 1, tolerance, base[5], $5)
+        }
+        check(pair, "algo_peak_bytes", 1, memory_tolerance, base[6], $6)
+        delete baseline[pair]
+    }
+    END {
+        for (pair in baseline) missing[++missing_count] = pair " is in the baseline but was not run"
+        for (i = 1; i <= missing_count; i++) print missing[i]
+        if (failed) {
+            printf "%-12s %-30s %-16s %14s %14s %10s\n", "house", "algorithm", "metric", "baseline", "current", "change"
+            for (i = 1; i <= failed; i++) print rows[i]
+        }
+        if (failed || missing_count) {
+            printf "perfcheck FAILED: %d regressions (tolerance: speed and latency %s, memory %s%%, score %s%%)\n", failed, check_timing ? tolerance "%" : "skipped", memory_tolerance, score_tolerance
+            exit 1
+        }
+        print "perfcheck passed"
+    }
+' "$BASELINE" "$WORK_DIR/results.csv"
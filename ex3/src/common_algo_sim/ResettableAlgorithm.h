@@ -0,0 +1,40 @@
+#ifndef RESETTABLE_ALGORITHM_H
+#define RESETTABLE_ALGORITHM_H
+
+/**
+ * @file ResettableAlgorithm.h
+ * @brief This file contains the declaration of the ResettableAlgorithm interface, an optional extension of AbstractAlgorithm.
+ */
+
+/**
+ * @brief An algorithm that also implements ResettableAlgorithm can be reset and run on another house, instead of the simulator
+ * creating a new instance for every run, so it can keep the memory of its containers between houses.
+ * The simulator finds it with dynamic_cast, algorithms that don't implement it keep working as before.
+ *
+ * Version 1 of the contract: after reset, the simulator calls setMaxSteps, setWallsSensor, setDirtSensor and setBatteryMeter
+ * (and setSeed, for a SeedableAlgorithm with a seed) as it does for a new instance, and the algorithm must then make exactly the steps
+ * a new instance would. reset is only called after a run that ended without an exception.
+ */
+class ResettableAlgorithm {
+public:
+	/**
+	 * @brief The version of the contract in this header, it changes whenever the contract does.
+	 */
+	static constexpr unsigned VERSION = 1;
+
+	virtual ~ResettableAlgorithm() {}
+
+	/**
+	 * @brief Gets the version of the contract the algorithm implements, which is VERSION as the algorithm was compiled.
+	 * The simulator only resets algorithms of its own version, and creates new instances of the others.
+	 */
+	virtual unsigned getResettableVersion() const = 0;
+
+	/**
+	 * @brief Forgets the last house, and may keep the memory of its containers.
+	 * The memory it keeps isn't counted as the memory of its next run, only what it allocates after reset is.
+	 */
+	virtual void reset() = 0;
+};
+
+#endif // RESETTABLE_ALGORITHM_H
@@ -0,0 +1,23 @@
+#ifndef SEEDABLE_ALGORITHM_H
+#define SEEDABLE_ALGORITHM_H
+
+/**
+ * @file SeedableAlgorithm.h
+ * @brief This file contains the declaration of the SeedableAlgorithm interface, an optional extension of AbstractAlgorithm.
+ */
+
+#include <cstdint>
+
+/**
+ * @brief An algorithm that also implements SeedableAlgorithm tells the simulator whether it's deterministic,
+ * and lets the simulator seed all of its randomness, so a run with a given seed can be reproduced.
+ * The simulator finds it with dynamic_cast, algorithms that don't implement it keep working as before.
+ */
+class SeedableAlgorithm {
+public:
+	virtual ~SeedableAlgorithm() {}
+	virtual bool isDeterministic() const = 0;
+	virtual void setSeed(std::uint64_t seed) = 0;
+};
+
+#endif // SEEDABLE_ALGORITHM_H
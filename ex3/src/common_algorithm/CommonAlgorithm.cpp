@@ -23,8 +23,36 @@ void CommonAlgorithm::setBatteryMeter(const BatteryMeter& batteryMeter) {
     charging_cap = max_battery;
 }
 
+bool CommonAlgorithm::isDeterministic() const {
+    return is_deterministic;
+}
+
+void CommonAlgorithm::setSeed(std::uint64_t seed) {
+    std::seed_seq seq{std::uint32_t(seed), std::uint32_t(seed >> 32)};
+    random_generator.seed(seq);
+}
+
+unsigned CommonAlgorithm::getResettableVersion() const {
+    return ResettableAlgorithm::VERSION;
+}
+
+/*
+Back to the state of a new instance, the maps keep their buckets and the vectors their capacity, so the next house doesn't rehash its way up again.
+Nothing iterates the maps, so their bucket counts can't change the steps.
+The rest of the members are set again by setMaxSteps and setBatteryMeter.
+*/
+void CommonAlgorithm::reset() {
+    random_generator.seed(std::random_device()());
+    path.clear();
+    coords_info.clear();
+    distances_from_docking.clear();
+    path_from_docking_parents.clear();
+    curr_loc = Coords(0, 0);
+    coords_info[Coords(0, 0)] = UNEXPLORED;
+}
+
 CommonAlgorithm::CommonAlgorithm(bool is_deterministic) 
-    : is_deterministic(is_deterministic) {
+    : is_deterministic(is_deterministic), random_generator(std::random_device()()) {
     curr_loc = Coords(0, 0);
     coords_info[Coords(0, 0)] = UNEXPLORED;
 }
@@ -85,12 +113,12 @@ void CommonAlgorithm::appendNeighbors(const Coords& current, std::deque<Coords>&
 /*
 Creates a path from start to target using "parents" map
 */
-CoordsVector CommonAlgorithm::createPathByParents(Coords start,Coords target,std::unordered_map<Coords,Coords> parents){
+CoordsVector CommonAlgorithm::createPathByParents(Coords start,Coords target,const std::unordered_map<Coords,Coords>& parents){
     CoordsVector next_path;
     next_path.push_back(target);
     Coords current = target;
-    while (parents[current] != start){
-        current = parents[current];
+    while (parents.at(current) != start){
+        current = parents.at(current);
         next_path.push_back(current);
     }
     
@@ -107,7 +135,6 @@ If is_deterministic, same target and same path to it will be elected in each run
 If !is_deterministic, some target will be chosen (from the most dirty closest cells), and some shortest path to it will be created.
 */
 CoordsVector CommonAlgorithm::bfs(size_t limiting_factor, bool updating_distances_from_docking){
-    static std::random_device rd;
     Coords current = updating_distances_from_docking ? Coords(0,0) : curr_loc; //Our starting point changes by our mission
     std::deque<Coords> queue = {current}; 
     std::unordered_map<Coords, Coords> local_parents;
@@ -142,12 +169,9 @@ CoordsVector CommonAlgorithm::bfs(size_t limiting_factor, bool updating_distance
             This way, we will pick one of the shortest paths randomly and even the target randomly (from the most prioritized targets)
             */
 
-             // Create a random number generator
-            std::mt19937 g(rd());
-
             // Shuffle the queue and the candidates
-            std::shuffle(queue.begin(), queue.end(), g);
-            std::shuffle(candidates.begin(), candidates.end(),g);
+            std::shuffle(queue.begin(), queue.end(), random_generator);
+            std::shuffle(candidates.begin(), candidates.end(), random_generator);
         }
         
         if (!candidates.empty()){ // Can happen only when looking for cleanable cells, otherwise we will run until no more reachable cells within the max_steps limit
@@ -199,11 +223,15 @@ Step CommonAlgorithm::marchTheNextStepOfThePath(){
 
 /*
 Calculates how many steps the robot will need to charge to make battery_state >= amount.
+A charging step adds max_battery/20, so n steps are enough once n*max_battery >= 20*amount_left (exact integers at any capacity).
+amount is at most max_battery, and the simulator rejects capacities over INT64_MAX/20 (see Battery::MAX_CAPACITY), so amount_left*20 doesn't wrap.
 */
 size_t CommonAlgorithm::stepsNumberToCharge(size_t amount){
-    size_t amount_left = amount - battery_meter->getBatteryState();
-    float charging_size = float(max_battery)/20;
-    return std::ceil(float(amount_left)/charging_size);
+    size_t battery_state = battery_meter->getBatteryState();
+    if(battery_state >= amount)
+        return 0;
+    size_t amount_left = amount - battery_state;
+    return (amount_left*20 + max_battery - 1)/max_battery;
 }
 
 Step CommonAlgorithm::nextStep(){
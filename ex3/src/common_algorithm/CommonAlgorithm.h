@@ -13,6 +13,8 @@
 #include "../common/AbstractAlgorithm.h"
 #include "AlgorithmRegistration.h"
 #include "../common_algo_sim/common.h"
+#include "../common_algo_sim/SeedableAlgorithm.h"
+#include "../common_algo_sim/ResettableAlgorithm.h"
 #include <unordered_map>
 #include <deque>
 #include <cstdlib>
@@ -25,7 +27,7 @@
  * @class CommonAlgorithm
  * @brief The CommonAlgorithm class represents the common functionality used by the robot to make decisions.
  */
-class CommonAlgorithm : public AbstractAlgorithm {
+class CommonAlgorithm : public AbstractAlgorithm, public SeedableAlgorithm, public ResettableAlgorithm {
 
     public:
         
@@ -38,6 +40,10 @@ class CommonAlgorithm : public AbstractAlgorithm {
         void setWallsSensor(const WallsSensor& wallSensor) override;
         void setDirtSensor(const DirtSensor& dirtSensor) override;
         void setBatteryMeter(const BatteryMeter& batteryMeter) override;
+        bool isDeterministic() const override;
+        void setSeed(std::uint64_t seed) override;
+        unsigned getResettableVersion() const override;
+        void reset() override;
     
     protected:
         CommonAlgorithm(bool is_deterministic);
@@ -50,9 +56,10 @@ class CommonAlgorithm : public AbstractAlgorithm {
         Step marchTheNextStepOfThePath();
         size_t stepsNumberToCharge(size_t amount);
         Step nextStep();
-        CoordsVector createPathByParents(Coords start,Coords target,std::unordered_map<Coords,Coords> parents);
+        CoordsVector createPathByParents(Coords start,Coords target,const std::unordered_map<Coords,Coords>& parents);
         
         bool is_deterministic;
+        std::mt19937 random_generator; //Seeded from std::random_device unless the simulator calls setSeed
         CoordsVector path;
         std::unordered_map<Coords, float> coords_info;
         std::unordered_map<Coords, size_t> distances_from_docking;
@@ -0,0 +1,362 @@
+/**
+ * @file SimDaemon.cpp
+ * @brief Implementation file for the SimDaemon class.
+ */
+#include "SimDaemon.h"
+#include "../simulator/TaskJournal.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// the files with the given extension in the directory, sorted so houses and algorithms keep their order between reloads
+static std::vector<std::filesystem::path> listFiles(const std::filesystem::path& dir, const std::string& extension) {
+    std::vector<std::filesystem::path> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if(entry.is_regular_file(ec) && entry.path().extension() == extension)
+            paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+static std::map<std::filesystem::path, std::filesystem::file_time_type> getWriteTimes(const std::vector<std::filesystem::path>& paths) {
+    std::map<std::filesystem::path, std::filesystem::file_time_type> times;
+    for (const auto& path : paths) {
+        std::error_code ec;
+        times[path] = std::filesystem::last_write_time(path, ec);
+    }
+    return times;
+}
+
+// a comma separated list of names, empty for "all"
+static std::set<std::string> parseNames(const std::string& list) {
+    std::set<std::string> names;
+    std::stringstream stream(list);
+    std::string name;
+    while (std::getline(stream, name, ','))
+        if(name != "")
+            names.insert(name);
+    return names;
+}
+
+// a client gets this long to send its whole request line, however slowly it sends it
+static constexpr std::chrono::seconds REQUEST_TIMEOUT{5};
+static constexpr std::size_t MAX_REQUEST_SIZE = 64 * 1024;
+
+// reads the request line, without its '\n', a client that closes its end before the '\n' sent the whole request
+// returns an error message, empty on success
+static std::string readRequest(int client_fd, std::string& request) {
+    auto deadline = std::chrono::steady_clock::now() + REQUEST_TIMEOUT;
+    char buffer[4096];
+    while(true) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd fd{client_fd, POLLIN, 0};
+        int ready = left.count() > 0 ? poll(&fd, 1, static_cast<int>(left.count())) : 0;
+        if(ready == 0)
+            return "Request timed out";
+        if(ready == -1 && errno == EINTR)
+            continue;
+        ssize_t count = ready == -1 ? -1 : recv(client_fd, buffer, sizeof(buffer), 0);
+        if(count == -1 && errno == EINTR)
+            continue;
+        if(count <= 0)
+            return "";
+        char* end = std::find(buffer, buffer + count, '\n');
+        request.append(buffer, end);
+        if(request.size() > MAX_REQUEST_SIZE)
+            return "Request too long, at most " + std::to_string(MAX_REQUEST_SIZE) + " bytes";
+        if(end != buffer + count)
+            return "";
+    }
+}
+
+SimDaemon::SimDaemon(Options options) : options(std::move(options)) {}
+
+SimDaemon::~SimDaemon() {
+    if(listen_fd != -1) {
+        close(listen_fd);
+        std::filesystem::remove(options.socket_path);
+    }
+    if(inotify_fd != -1)
+        close(inotify_fd);
+    // the factories point into the plugins, so they must be gone before the plugins are closed
+    algorithms.clear();
+    loader.unload();
+}
+
+std::string SimDaemon::start() {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotify_fd == -1)
+        return std::string("Failed to watch the directories: ") + std::strerror(errno);
+    // a replaced file (mv) and a rewritten one both count, a file is only reread once its writer closed it
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+    for (const auto& dir : {options.house_path, options.algo_path}) {
+        if(inotify_add_watch(inotify_fd, dir.c_str(), mask) == -1)
+            return "Failed to watch " + dir.string() + ": " + std::strerror(errno);
+    }
+
+    reload();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(options.socket_path.string().size() >= sizeof(address.sun_path))
+        return "Socket path is too long: " + options.socket_path.string();
+    std::strcpy(address.sun_path, options.socket_path.c_str());
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(listen_fd == -1)
+        return std::string("Failed to create the socket: ") + std::strerror(errno);
+    // a socket file left by a daemon that was killed
+    std::filesystem::remove(options.socket_path);
+    if(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 || listen(listen_fd, 16) == -1) {
+        std::string err = "Failed to listen on " + options.socket_path.string() + ": " + std::strerror(errno);
+        close(listen_fd);
+        listen_fd = -1;
+        return err;
+    }
+    return "";
+}
+
+void SimDaemon::serve() {
+    while(true) {
+        pollfd fds[2] = {{listen_fd, POLLIN, 0}, {inotify_fd, POLLIN, 0}};
+        if(poll(fds, 2, -1) == -1) {
+            if(errno == EINTR)
+                continue;
+            std::cerr << "poll failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        // changes are only applied when a request comes, never in the middle of a job
+        if(fds[1].revents & POLLIN)
+            drainWatchEvents();
+        if(fds[0].revents & POLLIN) {
+            int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if(client_fd == -1)
+                continue;
+            bool keep_serving = handleClient(client_fd);
+            close(client_fd);
+            if(!keep_serving)
+                return;
+        }
+    }
+}
+
+void SimDaemon::drainWatchEvents() {
+    alignas(inotify_event) char buffer[4096];
+    while(read(inotify_fd, buffer, sizeof(buffer)) > 0) {}
+    changed = true;
+}
+
+void SimDaemon::reload() {
+    drainWatchEvents();
+    reloadHouses();
+    reloadPlugins();
+    changed = false;
+}
+
+// only new and changed house files are parsed again
+void SimDaemon::reloadHouses() {
+    std::vector<std::filesystem::path> paths = listFiles(options.house_path, ".house");
+    auto write_times = getWriteTimes(paths);
+
+    std::map<std::filesystem::path, std::size_t> old_indices;
+    for (std::size_t i = 0; i < houses.size(); i++) {
+        old_indices[houses[i].house_path] = i;
+    }
+
+    std::vector<Simulator::HouseValues> new_houses;
+    for (const auto& path : paths) {
+        auto old_time = house_write_times.find(path);
+        bool unchanged = old_time != house_write_times.end() && old_time->second == write_times[path];
+        auto old_index = old_indices.find(path);
+        if(unchanged && old_index != old_indices.end()) {
+            new_houses.push_back(std::move(houses[old_index->second]));
+            continue;
+        }
+        if(unchanged)
+            continue; // still the same invalid house
+
+        Simulator::HouseValues hv = Simulator::readHouseFile(path);
+        if(hv.error_message == "")
+            new_houses.push_back(std::move(hv));
+        else
+            std::cerr << "Error in house file " << path << ": " << hv.error_message << std::endl;
+    }
+
+    houses = std::move(new_houses);
+    house_write_times = std::move(write_times);
+    house_names.clear();
+    for (const auto& hv : houses) {
+        house_names.push_back(hv.house_path.filename().replace_extension("").string());
+    }
+}
+
+// the registrar can't drop a single plugin, so any change reloads all of them
+void SimDaemon::reloadPlugins() {
+    std::vector<std::filesystem::path> paths = listFiles(options.algo_path, ".so");
+    auto write_times = getWriteTimes(paths);
+    if(write_times == plugin_write_times)
+        return;
+
+    algorithms.clear();
+    deterministic.clear();
+    std::string unload_error = loader.unload();
+    if(unload_error != "")
+        std::cerr << unload_error << std::endl;
+
+    for (const auto& load_error : loader.load(paths)) {
+        std::cerr << "Failed to load " << load_error.path << ": " << load_error.message << std::endl;
+    }
+    algorithms = loader.getAlgorithms();
+    for (const auto& algo : algorithms) {
+        deterministic.push_back(Simulator::isDeterministic(*algo.factory()));
+    }
+    plugin_write_times = std::move(write_times);
+}
+
+void SimDaemon::send(int client_fd, const std::string& line) {
+    std::string data = line + "\n";
+    std::lock_guard<std::mutex> lock(send_mutex);
+    if(client_lost)
+        return;
+    std::size_t sent = 0;
+    while(sent < data.size()) {
+        // a client that went away (or stopped reading, with SO_SNDTIMEO) doesn't stop the job (or the daemon, with MSG_NOSIGNAL),
+        // and a worker that sends from on_task_done waits for it once at most
+        ssize_t n = ::send(client_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if(n <= 0) {
+            client_lost = true;
+            return;
+        }
+        sent += n;
+    }
+}
+
+// returns false on QUIT
+bool SimDaemon::handleClient(int client_fd) {
+    // a client that sends its request slowly (or never ends it), or doesn't read what it's sent, mustn't block the daemon for long
+    timeval timeout{5, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    client_lost = false;
+
+    std::string request;
+    std::string err = readRequest(client_fd, request);
+    if(err != "") {
+        send(client_fd, "ERROR " + err);
+        return true;
+    }
+
+    if(changed)
+        reload();
+
+    std::string command = request.substr(0, request.find(' '));
+    if(command == "LIST") {
+        list(client_fd);
+    }
+    else if(command == "RUN") {
+        runJob(client_fd, request);
+    }
+    else if(command == "QUIT") {
+        send(client_fd, "OK");
+        return false;
+    }
+    else {
+        send(client_fd, "ERROR Unknown request: " + request);
+    }
+    return true;
+}
+
+void SimDaemon::list(int client_fd) {
+    for (const auto& name : house_names) {
+        send(client_fd, "HOUSE " + name);
+    }
+    for (std::size_t i = 0; i < algorithms.size(); i++) {
+        send(client_fd, "ALGORITHM " + algorithms[i].name + (deterministic[i] ? " deterministic" : " random"));
+    }
+    send(client_fd, "OK");
+}
+
+void SimDaemon::runJob(int client_fd, const std::string& request) {
+    auto start = std::chrono::steady_clock::now();
+    std::set<std::string> house_set, algorithm_set;
+    std::optional<std::uint64_t> seed;
+    bool steps = false;
+
+    std::stringstream words(request);
+    std::string word;
+    words >> word; // RUN
+    while(words >> word) {
+        try {
+            if(word.rfind("houses=", 0) == 0)
+                house_set = parseNames(word.substr(7));
+            else if(word.rfind("algorithms=", 0) == 0)
+                algorithm_set = parseNames(word.substr(11));
+            else if(word.rfind("seed=", 0) == 0)
+                seed = std::stoull(word.substr(5));
+            else if(word == "steps")
+                steps = true;
+            else
+                throw std::invalid_argument(word);
+        } catch (const std::exception& e) {
+            send(client_fd, "ERROR Invalid option: " + word);
+            return;
+        }
+    }
+
+    // the names left in the sets once they're matched are unknown
+    bool all_houses = house_set.empty(), all_algorithms = algorithm_set.empty();
+    std::vector<std::size_t> house_indices, algorithm_indices;
+    for (std::size_t i = 0; i < houses.size(); i++) {
+        if(all_houses || house_set.erase(house_names[i]))
+            house_indices.push_back(i);
+    }
+    for (std::size_t i = 0; i < algorithms.size(); i++) {
+        if(all_algorithms || algorithm_set.erase(algorithms[i].name))
+            algorithm_indices.push_back(i);
+    }
+    if(!house_set.empty() || !algorithm_set.empty()) {
+        send(client_fd, "ERROR Unknown house or algorithm: " + *(house_set.empty() ? algorithm_set : house_set).begin());
+        return;
+    }
+
+    // the same seeds as myrobot -seed
+    std::vector<BatchRunner::Task> tasks;
+    for (std::size_t h : house_indices) {
+        for (std::size_t a : algorithm_indices) {
+            BatchRunner::Task task{h, a};
+            if(seed && !deterministic[a])
+                task.seed = BatchRunner::deriveSeed(*seed, house_names[h], algorithms[a].name, 0);
+            tasks.push_back(task);
+        }
+    }
+
+    BatchOptions batch_options;
+    batch_options.num_threads = options.num_threads;
+    batch_options.affinity = options.affinity;
+    batch_options.record_steps = steps;
+    batch_options.on_task_done = [this, client_fd, &tasks, steps](std::size_t task_index, TaskResult& result) {
+        const std::string& house = house_names[tasks[task_index].house_index];
+        const std::string& algorithm = algorithms[tasks[task_index].algorithm_index].name;
+        std::string lines = "RESULT " + TaskJournal::formatRecord(house, algorithm, result);
+        if(steps)
+            lines += "\nSTEPS " + house + "," + algorithm + "," + result.steps;
+        send(client_fd, lines);
+        result.steps.clear();
+        result.steps.shrink_to_fit();
+    };
+    BatchRunner(houses, algorithms, batch_options).run(tasks);
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    send(client_fd, "DONE " + std::to_string(tasks.size()) + " tasks in " + std::to_string(duration.count()) + " ms");
+}
@@ -0,0 +1,80 @@
+#ifndef SIM_DAEMON_H
+#define SIM_DAEMON_H
+
+/**
+ * @file SimDaemon.h
+ * @brief This file contains the declaration of the SimDaemon class, which keeps houses and plugins resident and runs jobs sent over a UNIX domain socket.
+ */
+
+#include "../simulator/VacuumSim.h"
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The SimDaemon class parses the houses and loads the plugins once, and keeps them until their files change.
+ * It serves one request per connection, a single line:
+ *   LIST                                                      - the resident houses and algorithms
+ *   RUN [houses=<name>,..] [algorithms=<name>,..] [seed=<S>] [steps] - runs every house&algorithm pair of the given sets (all by default)
+ *   QUIT                                                      - stops the daemon
+ * The results of a RUN are streamed back as each task is done, a "RESULT <record>" line per task
+ * (the TaskJournal record: house,algorithm,score,num_steps,dirt_left,in_dock,status,outcome), followed by a "STEPS house,algorithm,<steps>" line with steps.
+ * The response ends with "DONE ..." or "ERROR <message>".
+ */
+class SimDaemon {
+public:
+    struct Options {
+        std::filesystem::path house_path;
+        std::filesystem::path algo_path;
+        std::filesystem::path socket_path = "myrobotd.sock";
+        std::size_t num_threads = 0; /**< 0 for BatchRunner::defaultThreadCount(). */
+        bool affinity = false;
+    };
+
+    SimDaemon(Options options);
+    SimDaemon(const SimDaemon&) = delete;
+    SimDaemon& operator=(const SimDaemon&) = delete;
+    ~SimDaemon();
+
+    /**
+     * @brief Loads the houses and plugins, starts watching their directories and listens on the socket.
+     * @return An error message, empty on success.
+     */
+    std::string start();
+
+    /**
+     * @brief Serves requests until a QUIT request.
+     */
+    void serve();
+
+private:
+    Options options;
+    int listen_fd = -1;
+    int inotify_fd = -1;
+    bool changed = true; // the directories changed since the last reload
+
+    std::map<std::filesystem::path, std::filesystem::file_time_type> house_write_times; // every .house file seen, valid or not
+    std::vector<Simulator::HouseValues> houses; // only the valid houses, sorted by path
+    std::vector<std::string> house_names;
+
+    AlgorithmLoader loader;
+    std::map<std::filesystem::path, std::filesystem::file_time_type> plugin_write_times;
+    std::vector<AlgorithmEntry> algorithms;
+    std::vector<bool> deterministic;
+
+    std::mutex send_mutex;
+    bool client_lost = false; // a send to the current client failed or timed out, nothing more is sent to it
+
+    void reload();
+    void reloadHouses();
+    void reloadPlugins();
+    void drainWatchEvents();
+    bool handleClient(int client_fd);
+    void list(int client_fd);
+    void runJob(int client_fd, const std::string& request);
+    void send(int client_fd, const std::string& line);
+};
+
+#endif // SIM_DAEMON_H
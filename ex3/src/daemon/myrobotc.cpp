@@ -0,0 +1,73 @@
+/**
+ * @file myrobotc.cpp
+ * @brief This file contains the client of the simulator daemon, it sends a single request and prints the response as it's streamed back.
+ *
+ * Usage:
+ *   myrobotc [-socket=FILE] LIST
+ *   myrobotc [-socket=FILE] RUN [houses=NAME,..] [algorithms=NAME,..] [seed=S] [steps]
+ *   myrobotc [-socket=FILE] QUIT
+ * Exits with failure if the daemon can't be reached or answers with an error.
+ */
+
+#include <iostream>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+    std::string socket_path = "myrobotd.sock";
+    std::string request;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg.rfind("-socket=", 0) == 0)
+            socket_path = arg.substr(8);
+        else
+            request += (request.empty() ? "" : " ") + arg;
+    }
+    if(request.empty()) {
+        std::cerr << "Usage: myrobotc [-socket=FILE] LIST | RUN [houses=..] [algorithms=..] [seed=..] [steps] | QUIT" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is too long: " << socket_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd == -1 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+        std::cerr << "Failed to connect to " << socket_path << ": " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    request += "\n";
+    if(write(fd, request.data(), request.size()) != (ssize_t)request.size()) {
+        std::cerr << "Failed to send the request: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    // the response is printed as it comes, the last line tells whether the request succeeded
+    std::string line;
+    bool failed = false;
+    char buffer[4096];
+    ssize_t n;
+    while((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            line += buffer[i];
+            if(buffer[i] == '\n') {
+                failed = failed || line.rfind("ERROR ", 0) == 0;
+                std::cout << line << std::flush;
+                line.clear();
+            }
+        }
+    }
+    close(fd);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file myrobotd.cpp
+ * @brief This file contains the simulator daemon, which keeps the houses and plugins resident and runs jobs sent to its socket.
+ *
+ * Usage:
+ *   myrobotd [-house_path=DIR] [-algo_path=DIR] [-socket=FILE] [-num_threads=N] [-affinity]
+ * Jobs are sent with myrobotc (see SimDaemon.h for the requests).
+ */
+
+#include "SimDaemon.h"
+#include <iostream>
+#include <regex>
+
+int main(int argc, char** argv) {
+    std::regex house_path_pattern(R"(-house_path=([^ ]+))");
+    std::regex algo_path_pattern(R"(-algo_path=([^ ]+))");
+    std::regex socket_pattern(R"(-socket=([^ ]+))");
+    std::regex num_threads_pattern(R"(-num_threads=(\d+))");
+    std::regex affinity_pattern(R"(-affinity)");
+    std::regex arg_patterns[] = {house_path_pattern, algo_path_pattern, socket_pattern, num_threads_pattern, affinity_pattern};
+    SimDaemon::Options options;
+    options.house_path = std::filesystem::current_path();
+    options.algo_path = std::filesystem::current_path();
+    std::string args;
+
+    if (argc > (int)std::size(arg_patterns) + 1) {
+        std::cerr << "Too many arguments!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        args += std::string(argv[i]) + " ";
+    }
+
+    for (size_t p = 0; p < std::size(arg_patterns); p++) {
+        std::smatch matches;
+        if(std::regex_search(args, matches, arg_patterns[p])) {
+            if(p==0) {
+                options.house_path = matches[1].str();
+            }
+            else if(p==1) {
+                options.algo_path = matches[1].str();
+            }
+            else if(p==2) {
+                options.socket_path = matches[1].str();
+            }
+            else if(p==3) {
+                try {
+                    options.num_threads = std::stoi(matches[1]);
+                } catch (std::out_of_range& e) {
+                    std::cerr << "Error: Number out of range" << std::endl;
+                }
+            }
+            else if(p==4) {
+                options.affinity = true;
+            }
+        }
+    }
+
+    SimDaemon daemon(options);
+    std::string err = daemon.start();
+    if(err != "") {
+        std::cerr << err << std::endl;
+        return EXIT_FAILURE;
+    }
+    daemon.serve();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,283 @@
+/**
+ * @file HouseGenerator.cpp
+ * @brief Implementation file for the HouseGenerator class.
+ */
+#include "HouseGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <utility>
+
+HouseGenerator::HouseGenerator(const Params& params) : params(params), gen(params.seed) {
+    this->params.rows = std::max<std::size_t>(this->params.rows, 1);
+    this->params.cols = std::max<std::size_t>(this->params.cols, 1);
+    this->params.room_size = std::max<std::size_t>(this->params.room_size, 2);
+    if(this->params.battery == 0)
+        this->params.battery = this->params.rows + this->params.cols;
+    if(this->params.max_steps == 0)
+        this->params.max_steps = 10 * this->params.rows * this->params.cols;
+}
+
+// splitmix64 of the corpus seed mixed with the index
+std::uint64_t HouseGenerator::deriveSeed(std::uint64_t seed, std::uint64_t index) {
+    std::uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+bool HouseGenerator::parseTopology(const std::string& name, Topology& topology) {
+    if(name == "open") topology = Topology::Open;
+    else if(name == "rooms") topology = Topology::Rooms;
+    else if(name == "corridors") topology = Topology::Corridors;
+    else if(name == "maze") topology = Topology::Maze;
+    else return false;
+    return true;
+}
+
+bool HouseGenerator::parseDirtDistribution(const std::string& name, DirtDistribution& dirt) {
+    if(name == "none") dirt = DirtDistribution::None;
+    else if(name == "uniform") dirt = DirtDistribution::Uniform;
+    else if(name == "clustered") dirt = DirtDistribution::Clustered;
+    else return false;
+    return true;
+}
+
+char& HouseGenerator::tile(std::size_t row, std::size_t col) {
+    return tiles[row * params.cols + col];
+}
+
+bool HouseGenerator::chance(double p) {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(gen) < p;
+}
+
+std::size_t HouseGenerator::randomBelow(std::size_t n) {
+    return std::uniform_int_distribution<std::size_t>(0, n - 1)(gen);
+}
+
+std::string HouseGenerator::generate(const std::string& title) {
+    gen.seed(params.seed);
+
+    switch (params.topology)
+    {
+    case Topology::Open:
+        buildOpen();
+        break;
+
+    case Topology::Rooms:
+        buildRooms();
+        break;
+
+    case Topology::Corridors:
+        buildCorridors();
+        break;
+
+    case Topology::Maze:
+        buildMaze();
+        break;
+    }
+
+    // the docking station is placed before the clutter, so its neighbors can be kept free
+    placeDockingStation();
+    addClutter();
+
+    if(params.dirt == DirtDistribution::Uniform)
+        addUniformDirt();
+    else if(params.dirt == DirtDistribution::Clustered)
+        addClusteredDirt();
+
+    std::string content = title + "\n";
+    content += "MaxSteps = " + std::to_string(params.max_steps) + "\n";
+    content += "MaxBattery = " + std::to_string(params.battery) + "\n";
+    content += "Rows = " + std::to_string(params.rows) + "\n";
+    content += "Cols = " + std::to_string(params.cols) + "\n";
+    content.reserve(content.size() + params.rows * (params.cols + 1));
+    for (std::size_t i = 0; i < params.rows; i++)
+    {
+        content.append(&tiles[i * params.cols], params.cols);
+        content += '\n';
+    }
+    tiles.clear();
+    tiles.shrink_to_fit();
+    return content;
+}
+
+bool HouseGenerator::writeHouseFile(const std::filesystem::path& file_path) {
+    std::string content = generate(file_path.stem().string());
+    std::ofstream file(file_path, std::ios::binary);
+    if(!file)
+        return false;
+    file.write(content.data(), content.size());
+    return bool(file);
+}
+
+void HouseGenerator::buildOpen() {
+    tiles.assign(params.rows * params.cols, ' ');
+}
+
+/*
+Walls split the house into a grid of rooms of random sizes around room_size,
+and every wall segment between two crossings gets a door, so all the rooms are connected.
+*/
+void HouseGenerator::buildRooms() {
+    tiles.assign(params.rows * params.cols, ' ');
+
+    auto wall_lines = [this](std::size_t length) {
+        std::vector<std::size_t> lines;
+        std::size_t min_gap = std::max<std::size_t>(params.room_size / 2, 1);
+        std::size_t pos = 0;
+        while ((pos += min_gap + randomBelow(params.room_size) + 1) < length - 1) {
+            lines.push_back(pos);
+        }
+        return lines;
+    };
+    std::vector<std::size_t> wall_rows = wall_lines(params.rows);
+    std::vector<std::size_t> wall_cols = wall_lines(params.cols);
+
+    for (std::size_t r : wall_rows)
+        for (std::size_t c = 0; c < params.cols; c++)
+            tile(r, c) = 'W';
+    for (std::size_t c : wall_cols)
+        for (std::size_t r = 0; r < params.rows; r++)
+            tile(r, c) = 'W';
+
+    // doors: one free tile in every segment between crossing walls (or the house's edges)
+    auto add_doors = [this](const std::vector<std::size_t>& lines, const std::vector<std::size_t>& crossing, bool horizontal) {
+        std::size_t length = horizontal ? params.cols : params.rows;
+        for (std::size_t line : lines) {
+            std::size_t from = 0;
+            for (std::size_t i = 0; i <= crossing.size(); i++) {
+                std::size_t to = i < crossing.size() ? crossing[i] : length;
+                if(to > from) {
+                    std::size_t door = from + randomBelow(to - from);
+                    (horizontal ? tile(line, door) : tile(door, line)) = ' ';
+                }
+                from = to + 1;
+            }
+        }
+    };
+    add_doors(wall_rows, wall_cols, true);
+    add_doors(wall_cols, wall_rows, false);
+}
+
+/*
+A grid of corridors every room_size tiles in a solid house, some corridor segments are blocked to create dead ends.
+*/
+void HouseGenerator::buildCorridors() {
+    tiles.assign(params.rows * params.cols, 'W');
+    std::size_t spacing = params.room_size;
+
+    for (std::size_t r = std::min(spacing / 2, params.rows / 2); r < params.rows; r += spacing)
+        for (std::size_t c = 0; c < params.cols; c++)
+            tile(r, c) = ' ';
+    for (std::size_t c = std::min(spacing / 2, params.cols / 2); c < params.cols; c += spacing)
+        for (std::size_t r = 0; r < params.rows; r++)
+            tile(r, c) = ' ';
+
+    // block some segments in the middle between two crossings
+    for (std::size_t r = std::min(spacing / 2, params.rows / 2); r < params.rows; r += spacing)
+        for (std::size_t c = std::min(spacing / 2, params.cols / 2) + spacing / 2; c < params.cols; c += spacing)
+            if(chance(0.1))
+                tile(r, c) = 'W';
+}
+
+/*
+A perfect maze (iterative recursive backtracker) whose cells are the tiles with even coordinates.
+*/
+void HouseGenerator::buildMaze() {
+    tiles.assign(params.rows * params.cols, 'W');
+    std::size_t cell_rows = (params.rows + 1) / 2, cell_cols = (params.cols + 1) / 2;
+    std::vector<bool> visited(cell_rows * cell_cols, false);
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+
+    stack.emplace_back(randomBelow(cell_rows), randomBelow(cell_cols));
+    visited[stack.back().first * cell_cols + stack.back().second] = true;
+    tile(2 * stack.back().first, 2 * stack.back().second) = ' ';
+
+    const int dr[4] = {-1, 0, 1, 0};
+    const int dc[4] = {0, 1, 0, -1};
+    while (!stack.empty()) {
+        auto [r, c] = stack.back();
+        std::size_t options[4];
+        std::size_t options_num = 0;
+        for (std::size_t d = 0; d < 4; d++) {
+            long nr = long(r) + dr[d], nc = long(c) + dc[d];
+            if(nr >= 0 && nc >= 0 && std::size_t(nr) < cell_rows && std::size_t(nc) < cell_cols && !visited[nr * cell_cols + nc])
+                options[options_num++] = d;
+        }
+        if(options_num == 0) {
+            stack.pop_back();
+            continue;
+        }
+        std::size_t d = options[randomBelow(options_num)];
+        std::size_t nr = r + dr[d], nc = c + dc[d];
+        visited[nr * cell_cols + nc] = true;
+        tile(r + nr, c + nc) = ' '; // the wall between the two cells
+        tile(2 * nr, 2 * nc) = ' ';
+        stack.emplace_back(nr, nc);
+    }
+}
+
+void HouseGenerator::addClutter() {
+    if(params.wall_density <= 0)
+        return;
+    for (std::size_t r = 0; r < params.rows; r++) {
+        for (std::size_t c = 0; c < params.cols; c++) {
+            char& t = tile(r, c);
+            if(t != ' ' || !chance(params.wall_density))
+                continue;
+            // keep the docking station's neighbors free
+            bool near_docking = (r > 0 && tile(r - 1, c) == 'D') || (r + 1 < params.rows && tile(r + 1, c) == 'D') ||
+                                (c > 0 && tile(r, c - 1) == 'D') || (c + 1 < params.cols && tile(r, c + 1) == 'D');
+            if(!near_docking)
+                t = 'W';
+        }
+    }
+}
+
+void HouseGenerator::placeDockingStation() {
+    std::size_t size = tiles.size();
+    std::size_t start = randomBelow(size);
+    for (std::size_t i = 0; i < size; i++) {
+        char& t = tiles[(start + i) % size];
+        if(t == ' ') {
+            t = 'D';
+            return;
+        }
+    }
+    // a house made only of walls - the docking station takes the place of one
+    tiles[start] = 'D';
+}
+
+void HouseGenerator::addUniformDirt() {
+    std::uniform_int_distribution<int> level(1, 9);
+    for (char& t : tiles) {
+        if(t == ' ' && chance(params.dirt_density))
+            t = char('0' + level(gen));
+    }
+}
+
+/*
+Dirt piles of radius around room_size/2 whose dirt level decreases towards their edge,
+their number is chosen so the dirty area is roughly dirt_density of the house.
+*/
+void HouseGenerator::addClusteredDirt() {
+    double radius = std::max<double>(2.0, params.room_size / 2.0);
+    double cluster_area = radius * radius * 3.14159 / 2; // half of the tiles in a cluster's circle are dirty on average
+    std::size_t clusters = std::max<std::size_t>(1, std::size_t(tiles.size() * params.dirt_density / cluster_area));
+    long reach = long(radius);
+
+    for (std::size_t k = 0; k < clusters; k++) {
+        long center_r = randomBelow(params.rows), center_c = randomBelow(params.cols);
+        for (long r = std::max(0L, center_r - reach); r <= std::min(long(params.rows) - 1, center_r + reach); r++) {
+            for (long c = std::max(0L, center_c - reach); c <= std::min(long(params.cols) - 1, center_c + reach); c++) {
+                double closeness = 1.0 - std::hypot(double(r - center_r), double(c - center_c)) / radius;
+                char& t = tile(r, c);
+                if(closeness <= 0 || !(t == ' ' || ('1' <= t && t <= '9')) || !chance(closeness))
+                    continue;
+                char level = char('1' + std::lround(8 * closeness));
+                t = std::max(t == ' ' ? '0' : t, level);
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef HOUSE_GENERATOR_H
+#define HOUSE_GENERATOR_H
+
+/**
+ * @file HouseGenerator.h
+ * @brief This file contains the declaration of the HouseGenerator class, which creates random (but seeded) .house files.
+ */
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+/**
+ * @brief The HouseGenerator class generates the content of a valid .house file from a set of parameters.
+ * The same parameters (including the seed) always produce the same house.
+ */
+class HouseGenerator {
+public:
+    enum class Topology { Open, Rooms, Corridors, Maze };
+    enum class DirtDistribution { None, Uniform, Clustered };
+
+    struct Params {
+        std::size_t rows = 100;
+        std::size_t cols = 100;
+        Topology topology = Topology::Rooms;
+        double wall_density = 0.05; /**< Probability of a free tile to become a wall, on top of the topology's walls. */
+        std::size_t room_size = 10; /**< Average room size (rooms) or distance between corridors (corridors). */
+        DirtDistribution dirt = DirtDistribution::Uniform;
+        double dirt_density = 0.3; /**< Probability of a free tile to be dirty (for clustered - the overall dirty area). */
+        std::size_t battery = 0; /**< 0 means rows + cols, which lets the robot reach most of the house. */
+        std::size_t max_steps = 0; /**< 0 means 10 * rows * cols. */
+        std::uint64_t seed = 0;
+    };
+
+    /**
+     * @brief Constructs a HouseGenerator for the given parameters.
+     * @param params The generation parameters.
+     */
+    HouseGenerator(const Params& params);
+
+    /**
+     * @brief Generates the house.
+     * @param title The first (title) line of the house file.
+     * @return The content of the .house file.
+     */
+    std::string generate(const std::string& title);
+
+    /**
+     * @brief Generates the house and writes it to a file.
+     * @param file_path The path of the .house file to create.
+     * @return True on success, false if the file could not be written.
+     */
+    bool writeHouseFile(const std::filesystem::path& file_path);
+
+    /**
+     * @brief Derives an independent seed for the index-th house of a corpus, so a corpus does not depend on the order in which houses are generated.
+     * @param seed The seed of the whole corpus.
+     * @param index The index of the house in the corpus.
+     * @return The seed of that house.
+     */
+    static std::uint64_t deriveSeed(std::uint64_t seed, std::uint64_t index);
+
+    static bool parseTopology(const std::string& name, Topology& topology);
+
+    static bool parseDirtDistribution(const std::string& name, DirtDistribution& dirt);
+
+private:
+    Params params;
+    std::mt19937_64 gen;
+    std::vector<char> tiles;
+
+    char& tile(std::size_t row, std::size_t col);
+    bool chance(double p);
+    std::size_t randomBelow(std::size_t n);
+
+    void buildOpen();
+    void buildRooms();
+    void buildCorridors();
+    void buildMaze();
+    void addClutter();
+    void placeDockingStation();
+    void addUniformDirt();
+    void addClusteredDirt();
+};
+
+#endif // HOUSE_GENERATOR_H
@@ -0,0 +1,121 @@
+/**
+ * @file gen_houses.cpp
+ * @brief This file contains a tool that generates a reproducible corpus of .house files for scale and stress testing.
+ *
+ * Usage: gen_houses [-out=DIR] [-count=N] [-seed=S] [-prefix=NAME] [-num_threads=N] [-size=N | -rows=N -cols=N]
+ *                   [-topology=open|rooms|corridors|maze] [-wall_density=P] [-room_size=N]
+ *                   [-dirt=none|uniform|clustered] [-dirt_density=P] [-battery=N] [-max_steps=N]
+ * The i-th house is named PREFIX_i.house and only depends on the parameters, the seed and i.
+ */
+
+#include "HouseGenerator.h"
+#include <atomic>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GeneratorRun {
+    HouseGenerator::Params params;
+    std::filesystem::path out_dir = std::filesystem::current_path();
+    std::string prefix = "gen";
+    std::size_t count = 1;
+    std::atomic<std::size_t> counter{0};
+    std::atomic<bool> failed{false};
+};
+
+std::filesystem::path house_file_path(const GeneratorRun& run, std::size_t index) {
+    std::string number = std::to_string(index);
+    std::string width = std::to_string(run.count - 1);
+    number.insert(0, width.size() - number.size(), '0'); // zero padded so the files sort by index
+    return run.out_dir / (run.prefix + "_" + number + ".house");
+}
+
+void generate_houses(GeneratorRun& run) {
+    std::size_t my_house;
+    while((my_house = run.counter++) < run.count) {
+        HouseGenerator::Params params = run.params;
+        params.seed = HouseGenerator::deriveSeed(run.params.seed, my_house);
+        std::filesystem::path path = house_file_path(run, my_house);
+        if(!HouseGenerator(params).writeHouseFile(path)) {
+            std::cerr << "Could not write " << path << std::endl;
+            run.failed = true;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    GeneratorRun run;
+    std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::regex arg_pattern(R"(-(\w+)=(\S+))");
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::smatch matches;
+        if(!std::regex_match(arg, matches, arg_pattern)) {
+            std::cerr << "Invalid argument: " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string name = matches[1], value = matches[2];
+        try {
+            if(name == "out") run.out_dir = value;
+            else if(name == "prefix") run.prefix = value;
+            else if(name == "count") run.count = std::stoull(value);
+            else if(name == "seed") run.params.seed = std::stoull(value);
+            else if(name == "num_threads") num_threads = std::max<std::size_t>(1, std::stoull(value));
+            else if(name == "size") run.params.rows = run.params.cols = std::stoull(value);
+            else if(name == "rows") run.params.rows = std::stoull(value);
+            else if(name == "cols") run.params.cols = std::stoull(value);
+            else if(name == "room_size") run.params.room_size = std::stoull(value);
+            else if(name == "wall_density") run.params.wall_density = std::stod(value);
+            else if(name == "dirt_density") run.params.dirt_density = std::stod(value);
+            else if(name == "battery") run.params.battery = std::stoull(value);
+            else if(name == "max_steps") run.params.max_steps = std::stoull(value);
+            else if(name == "topology") {
+                if(!HouseGenerator::parseTopology(value, run.params.topology)) {
+                    std::cerr << "Unknown topology: " << value << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else if(name == "dirt") {
+                if(!HouseGenerator::parseDirtDistribution(value, run.params.dirt)) {
+                    std::cerr << "Unknown dirt distribution: " << value << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+        } catch (std::invalid_argument& e) {
+            std::cerr << "Error: Invalid number format in " << arg << std::endl;
+            return EXIT_FAILURE;
+        } catch (std::out_of_range& e) {
+            std::cerr << "Error: Number out of range in " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(run.count == 0)
+        return EXIT_SUCCESS;
+
+    try {
+        std::filesystem::create_directories(run.out_dir);
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Filesystem error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::thread> threads;
+    num_threads = std::min(num_threads, run.count);
+    threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back(generate_houses, std::ref(run));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return run.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
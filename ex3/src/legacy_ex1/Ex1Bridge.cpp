@@ -0,0 +1,76 @@
+/**
+ * @file Ex1Bridge.cpp
+ * @brief Implementation file for the Ex1Bridge class, and the parts of ex1's Robot that ex1's Algorithm uses.
+ * ex1's Robot.cpp isn't built into the plugin, the Robot defined here only answers the Algorithm's questions from the sensors
+ * (the simulator moves, cleans and charges).
+ */
+#include "Ex1Bridge.h"
+#include "Ex1Rand.h"
+#include "../../../ex1/src/Robot.h"
+#include <random>
+
+// the sensors and random engine of the bridge whose Algorithm is deciding on this thread
+static thread_local const Ex1Bridge::Sensors* current_sensors = nullptr;
+static thread_local std::mt19937* current_random = nullptr;
+
+// ex1's Algorithm calls rand(), whose state the whole process shares, so the threads' runs would take each other's numbers.
+// Its calls are renamed to ex1_rand when it's compiled, which draws from the engine of the deciding bridge instead.
+int ex1_rand() {
+    static thread_local std::mt19937 outside_bridge;
+    std::uniform_int_distribution<int> distribution(0, RAND_MAX);
+    return distribution(current_random ? *current_random : outside_bridge);
+}
+
+Robot::Robot(House& house, size_t battery_capacity)
+    : house(house), location(), battery_capacity(battery_capacity), battery_left(battery_capacity), algo(this) {}
+
+bool* Robot::getSurroundingWalls() {
+    // the Algorithm deletes it
+    bool* walls = new bool[4];
+    for (int i = 0; i < 4; i++) {
+        walls[i] = current_sensors->isWall(i);
+    }
+    return walls;
+}
+
+size_t Robot::getCurrentCoordsDirt() const {
+    return current_sensors->dirtLevel();
+}
+
+float Robot::getBatteryLeft() const {
+    return current_sensors->getBatteryState();
+}
+
+Step Robot::performNextStep() {
+    return algo.decide_next_step();
+}
+
+struct Ex1Bridge::Impl {
+    House house{House::Matrix(), Coords(), 0}; // the Robot needs one, it's never read
+    Robot robot{house, 0};
+    std::mt19937 random{std::random_device()()};
+};
+
+Ex1Bridge::Ex1Bridge(const Sensors& sensors) : impl(std::make_unique<Impl>()), sensors(sensors) {}
+
+Ex1Bridge::~Ex1Bridge() = default;
+
+int Ex1Bridge::nextStep() {
+    current_sensors = &sensors;
+    current_random = &impl->random;
+    Step step = impl->robot.performNextStep();
+    current_sensors = nullptr;
+    current_random = nullptr;
+    if(step.type != MOVE)
+        return -1;
+    for (int i = 0; i < 4; i++) {
+        if(DIRECTIONS[i] == step.coords)
+            return i;
+    }
+    return -1;
+}
+
+void Ex1Bridge::setSeed(std::uint64_t seed) {
+    std::seed_seq seq{std::uint32_t(seed), std::uint32_t(seed >> 32)};
+    impl->random.seed(seq);
+}
@@ -0,0 +1,51 @@
+#ifndef EX1_BRIDGE_H
+#define EX1_BRIDGE_H
+
+/**
+ * @file Ex1Bridge.h
+ * @brief This file contains the declaration of the Ex1Bridge class, which runs ex1's Algorithm on sensors instead of ex1's Robot and House.
+ * ex1 and ex3 both define Step and Coords, differently, so the two sides only meet through this header, which includes neither.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief The Ex1Bridge class owns an ex1 Algorithm and gets its decisions.
+ * ex1's Algorithm asks its Robot for the walls around it, the dirt under it and the battery, and here the Robot answers from the given Sensors.
+ * Its rand() calls draw from a random engine of the bridge (they're renamed to the plugin's ex1_rand), so every instance has its own sequence.
+ */
+class Ex1Bridge {
+public:
+    /**
+     * @brief What ex1's Robot is asked, a direction being an index into ex1's DIRECTIONS (up, right, down, left).
+     */
+    struct Sensors {
+        virtual ~Sensors() = default;
+        virtual bool isWall(int direction) const = 0;
+        virtual int dirtLevel() const = 0;
+        virtual std::size_t getBatteryState() const = 0;
+    };
+
+    Ex1Bridge(const Sensors& sensors);
+    ~Ex1Bridge();
+
+    /**
+     * @brief Gets the algorithm's next decision.
+     * @return The direction (an index into ex1's DIRECTIONS) to move to, or -1 to stay (clean or charge).
+     */
+    int nextStep();
+
+    /**
+     * @brief Seeds the bridge's random engine, which is seeded from std::random_device otherwise.
+     */
+    void setSeed(std::uint64_t seed);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    const Sensors& sensors;
+};
+
+#endif // EX1_BRIDGE_H
@@ -0,0 +1,20 @@
+#ifndef EX1_RAND_H
+#define EX1_RAND_H
+
+/**
+ * @file Ex1Rand.h
+ * @brief This file is forced into ex1's translation units (-include in the Makefile), so their rand() calls go to ex1_rand(), defined in Ex1Bridge.cpp.
+ * The C library's rand() is declared before it's renamed, so ex1's own #include <cstdlib> declares nothing new.
+ */
+
+#include <cstdlib>
+
+/**
+ * @brief Draws from the random engine of the bridge whose Algorithm is deciding on this thread.
+ * @return A number between 0 and RAND_MAX, as rand() does.
+ */
+int ex1_rand();
+
+#define rand ex1_rand
+
+#endif // EX1_RAND_H
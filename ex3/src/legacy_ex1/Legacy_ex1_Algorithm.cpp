@@ -0,0 +1,50 @@
+#include "Legacy_ex1_Algorithm.h"
+#include "../common_algorithm/AlgorithmRegistration.h"
+
+REGISTER_ALGORITHM(Legacy_ex1_Algorithm);
+
+// ex1's DIRECTIONS are up, right, down and left
+static const Direction directions[4] = {Direction::North, Direction::East, Direction::South, Direction::West};
+static const Step steps[4] = {Step::North, Step::East, Step::South, Step::West};
+
+Legacy_ex1_Algorithm::Legacy_ex1_Algorithm() : bridge(*this) {}
+
+// ex1's Algorithm knows nothing of a step budget
+void Legacy_ex1_Algorithm::setMaxSteps(std::size_t) {}
+
+void Legacy_ex1_Algorithm::setWallsSensor(const WallsSensor& walls_sensor) {
+    this->walls_sensor = &walls_sensor;
+}
+
+void Legacy_ex1_Algorithm::setDirtSensor(const DirtSensor& dirt_sensor) {
+    this->dirt_sensor = &dirt_sensor;
+}
+
+void Legacy_ex1_Algorithm::setBatteryMeter(const BatteryMeter& battery_meter) {
+    this->battery_meter = &battery_meter;
+}
+
+Step Legacy_ex1_Algorithm::nextStep() {
+    int direction = bridge.nextStep();
+    return direction == -1 ? Step::Stay : steps[direction];
+}
+
+bool Legacy_ex1_Algorithm::isDeterministic() const {
+    return false;
+}
+
+void Legacy_ex1_Algorithm::setSeed(std::uint64_t seed) {
+    bridge.setSeed(seed);
+}
+
+bool Legacy_ex1_Algorithm::isWall(int direction) const {
+    return walls_sensor->isWall(directions[direction]);
+}
+
+int Legacy_ex1_Algorithm::dirtLevel() const {
+    return dirt_sensor->dirtLevel();
+}
+
+std::size_t Legacy_ex1_Algorithm::getBatteryState() const {
+    return battery_meter->getBatteryState();
+}
@@ -0,0 +1,45 @@
+#ifndef LEGACY_EX1_ALGORITHM_H
+#define LEGACY_EX1_ALGORITHM_H
+
+/**
+ * @file Legacy_ex1_Algorithm.h
+ * @brief This file contains the declaration of the Legacy_ex1_Algorithm class, ex1's random walk algorithm as an ex3 plugin.
+ */
+
+#include "../common/AbstractAlgorithm.h"
+#include "../common_algo_sim/SeedableAlgorithm.h"
+#include "Ex1Bridge.h"
+
+/**
+ * @brief The Legacy_ex1_Algorithm class adapts ex1's Algorithm to the AbstractAlgorithm interface, for comparing the generations of our algorithm.
+ * ex1's Algorithm walks randomly (with rand()), returns to the docking station by retracing its path, and never finishes.
+ */
+class Legacy_ex1_Algorithm : public AbstractAlgorithm, public SeedableAlgorithm, private Ex1Bridge::Sensors {
+public:
+    Legacy_ex1_Algorithm();
+
+    void setMaxSteps(std::size_t max_steps) override;
+    void setWallsSensor(const WallsSensor& walls_sensor) override;
+    void setDirtSensor(const DirtSensor& dirt_sensor) override;
+    void setBatteryMeter(const BatteryMeter& battery_meter) override;
+    Step nextStep() override;
+
+    bool isDeterministic() const override;
+
+    /**
+     * @brief Seeds the random engine behind the rand() calls of ex1's Algorithm (see Ex1Bridge).
+     */
+    void setSeed(std::uint64_t seed) override;
+
+private:
+    const WallsSensor* walls_sensor = nullptr;
+    const DirtSensor* dirt_sensor = nullptr;
+    const BatteryMeter* battery_meter = nullptr;
+    Ex1Bridge bridge;
+
+    bool isWall(int direction) const override;
+    int dirtLevel() const override;
+    std::size_t getBatteryState() const override;
+};
+
+#endif // LEGACY_EX1_ALGORITHM_H
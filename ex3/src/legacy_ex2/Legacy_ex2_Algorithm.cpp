@@ -0,0 +1,4 @@
+#include "Legacy_ex2_Algorithm.h"
+#include "../common_algorithm/AlgorithmRegistration.h"
+
+REGISTER_ALGORITHM(Legacy_ex2_Algorithm);
@@ -0,0 +1,18 @@
+#ifndef LEGACY_EX2_ALGORITHM_H
+#define LEGACY_EX2_ALGORITHM_H
+
+/**
+ * @file Legacy_ex2_Algorithm.h
+ * @brief This file contains the declaration of the Legacy_ex2_Algorithm class, ex2's BFS algorithm as an ex3 plugin.
+ */
+
+// ex2's AbstractAlgorithm and sensors are ex3's (the same headers, under other file names), so ex2's Algorithm is already an ex3 algorithm
+#include "../../../ex2/src/Algorithm.h"
+
+/**
+ * @brief The Legacy_ex2_Algorithm class is ex2's Algorithm under a name of its own, for comparing the generations of our algorithm.
+ */
+class Legacy_ex2_Algorithm : public Algorithm {
+};
+
+#endif // LEGACY_EX2_ALGORITHM_H
@@ -0,0 +1,150 @@
+/**
+ * @file Replayer.cpp
+ * @brief Implementation file for the Replayer class.
+ */
+#include "Replayer.h"
+#include <regex>
+#include <sstream>
+
+std::string Replayer::readOutputFile(const std::filesystem::path& file_path, OutputValues& ov) {
+    std::ifstream file(file_path);
+    if(!file) {
+        return "Output file \"" + file_path.string() + "\" does not exist";
+    }
+
+    std::string line;
+    std::regex value_pattern(R"(^(\w+) = (\w+)$)");
+    bool found[5] = {false, false, false, false, false};
+    const std::string names[5] = {"NumSteps", "DirtLeft", "Status", "InDock", "Score"};
+
+    while (std::getline(file, line) && line != "Steps:") {
+        std::smatch matches;
+        if(!std::regex_match(line, matches, value_pattern)) {
+            return "invalid line: \"" + line + "\"";
+        }
+        std::string value = matches[2];
+        try {
+            if(matches[1] == names[0]) ov.num_steps = std::stoull(value);
+            else if(matches[1] == names[1]) ov.dirt_left = std::stoull(value);
+            else if(matches[1] == names[2]) ov.status = value;
+            else if(matches[1] == names[3]) ov.in_dock = value == "TRUE";
+            else if(matches[1] == names[4]) ov.score = std::stoull(value);
+            else return "unknown value: \"" + line + "\"";
+        } catch (std::exception& e) {
+            return "invalid number in line: \"" + line + "\"";
+        }
+        for (size_t i = 0; i < 5; i++)
+            found[i] = found[i] || matches[1] == names[i];
+    }
+    for (size_t i = 0; i < 5; i++) {
+        if(!found[i])
+            return "missing " + names[i];
+    }
+    if(line != "Steps:") {
+        return "missing Steps";
+    }
+    std::getline(file, ov.steps);
+    return "";
+}
+
+Replayer::ReplayResults Replayer::replay(const Simulator::HouseValues& hv, const std::string& steps) {
+    ReplayResults rr;
+    House house;
+    house.setTiles(House::Matrix(hv.tiles)); // the house values are shared between replays, so we work on a copy
+    house.setDockingStation(hv.docking_station);
+    house.setTotalDirt(hv.total_dirt);
+
+    const Coords docking_station = hv.docking_station;
+    // the battery is kept exactly like Simulator keeps it
+    Battery battery(hv.battery_capacity);
+    Coords location = docking_station;
+    bool finished = false;
+    size_t i = 0;
+
+    for (; i < steps.size(); i++)
+    {
+        char step = steps[i];
+        if(finished) {
+            rr.error_message = "step " + std::to_string(i + 1) + " comes after Finish";
+            break;
+        }
+        // the simulator stops a robot with an empty battery outside the docking station, and can't move it out of there
+        if(battery.isEmpty() && (location != docking_station || (step != 's' && step != 'F'))) {
+            rr.error_message = "step " + std::to_string(i + 1) + " is taken with an empty battery";
+            break;
+        }
+        if(step == 'F') {
+            finished = true;
+            continue;
+        }
+        if(i >= hv.maxSteps) {
+            rr.error_message = "more than MaxSteps (" + std::to_string(hv.maxSteps) + ") steps";
+            break;
+        }
+
+        switch (step)
+        {
+        case 'N':
+            location += Direction::North;
+            break;
+        case 'E':
+            location += Direction::East;
+            break;
+        case 'S':
+            location += Direction::South;
+            break;
+        case 'W':
+            location += Direction::West;
+            break;
+        case 's':
+            if(location == docking_station) {
+                battery.charge();
+                continue;
+            }
+            house.cleanOnce(location);
+            break;
+        default:
+            rr.error_message = "invalid step character '" + std::string(1, step) + "' at step " + std::to_string(i + 1);
+            break;
+        }
+        if(!rr.error_message.empty())
+            break;
+
+        battery.discharge();
+        if(step != 's' && house.isWall(location)) {
+            rr.error_message = "step " + std::to_string(i + 1) + " runs into a wall at " + (std::ostringstream() << location).str();
+            break;
+        }
+    }
+
+    bool in_dock = location == docking_station;
+    rr.num_steps = i - finished;
+    rr.dirt_left = house.getTotalDirt();
+    rr.status = Simulator::calcStatus(finished, battery.isDepleted());
+    rr.in_dock = in_dock;
+    rr.score = Simulator::calcScore(hv.maxSteps, hv.total_dirt, rr.dirt_left, i, finished, battery.isDepleted(), in_dock, false);
+    rr.timeout_score = Simulator::calcScore(hv.maxSteps, hv.total_dirt, rr.dirt_left, i, finished, battery.isDepleted(), in_dock, true);
+    return rr;
+}
+
+std::string Replayer::validate(const Simulator::HouseValues& hv, const OutputValues& ov, ReplayResults& rr) {
+    rr = replay(hv, ov.steps);
+    if(!rr.error_message.empty())
+        return rr.error_message;
+
+    // a timed out run is cut at an arbitrary step, so only its (default) score can be checked
+    if(ov.score == rr.timeout_score && ov.score != rr.score)
+        return "";
+
+    if(ov.num_steps != rr.num_steps)
+        return "NumSteps is " + std::to_string(ov.num_steps) + " but the steps string has " + std::to_string(rr.num_steps);
+    if(ov.dirt_left != rr.dirt_left)
+        return "DirtLeft is " + std::to_string(ov.dirt_left) + " but replaying leaves " + std::to_string(rr.dirt_left);
+    if(ov.status != rr.status)
+        return "Status is " + ov.status + " but replaying ends " + rr.status;
+    if(ov.in_dock != rr.in_dock)
+        return std::string("InDock is ") + (ov.in_dock ? "TRUE" : "FALSE") + " but replaying ends " + (rr.in_dock ? "in" : "out of") + " the docking station";
+    if(ov.score != rr.score)
+        return "Score is " + std::to_string(ov.score) + " but replaying scores " + std::to_string(rr.score);
+    return "";
+}
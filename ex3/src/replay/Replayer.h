@@ -0,0 +1,71 @@
+#ifndef REPLAYER_H
+#define REPLAYER_H
+
+/**
+ * @file Replayer.h
+ * @brief This file contains the declaration of the Replayer class, which validates output files by replaying their steps.
+ */
+
+#include "../simulator/House.h"
+#include "../simulator/Simulator.h"
+#include <string>
+#include <filesystem>
+
+/**
+ * @brief The Replayer class re-executes a steps string against a house (no algorithm is involved)
+ * and checks the results claimed in an output file.
+ */
+class Replayer {
+public:
+    /**
+     * @brief The values written to an output file by Simulator::calcScoreAndWriteResults.
+     */
+    struct OutputValues {
+        std::size_t num_steps = 0;
+        std::size_t dirt_left = 0;
+        std::string status = "";
+        bool in_dock = false;
+        std::size_t score = 0;
+        std::string steps = "";
+    };
+
+    /**
+     * @brief The outcome of a replay.
+     */
+    struct ReplayResults {
+        std::string error_message = ""; /**< Empty if the steps are legal. */
+        std::size_t num_steps = 0; /**< Not counting the Finish step, like the output file. */
+        std::size_t dirt_left = 0;
+        std::string status = "";
+        bool in_dock = false;
+        std::size_t score = 0;
+        std::size_t timeout_score = 0; /**< The default score the simulator gives on timeout. */
+    };
+
+    /**
+     * @brief Reads an output file.
+     * @param file_path The path of the output file.
+     * @param ov The values read from the file.
+     * @return An error message, empty on success.
+     */
+    static std::string readOutputFile(const std::filesystem::path& file_path, OutputValues& ov);
+
+    /**
+     * @brief Replays the steps on the house, with the simulator's rules.
+     * @param hv The house (as read by Simulator::readHouseFile), it is not modified.
+     * @param steps The steps string (N/E/S/W/s, optionally ending with F).
+     * @return The replay results, with an error message on the first illegal step.
+     */
+    static ReplayResults replay(const Simulator::HouseValues& hv, const std::string& steps);
+
+    /**
+     * @brief Replays an output file's steps and compares the results with the claimed values.
+     * @param hv The house the output file was created for.
+     * @param ov The values read from the output file.
+     * @param rr The replay results.
+     * @return An empty string if the output file is valid, otherwise a description of the first mismatch.
+     */
+    static std::string validate(const Simulator::HouseValues& hv, const OutputValues& ov, ReplayResults& rr);
+};
+
+#endif // REPLAYER_H
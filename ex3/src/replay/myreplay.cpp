@@ -0,0 +1,182 @@
+/**
+ * @file myreplay.cpp
+ * @brief This file contains a tool that validates output files by replaying their steps against the house, without loading any algorithm.
+ *
+ * Usage:
+ *   myreplay -house=FILE -steps=STEPS                   replays a steps string and prints its results
+ *   myreplay -house=FILE -output=FILE                   validates a single output file
+ *   myreplay -house_path=DIR -results_path=DIR [-num_threads=N]
+ *                                                       validates every HOUSE-ALGORITHM.txt in results_path against HOUSE.house in house_path
+ * Validation prints one CSV row per output file and exits with failure if any of them is invalid.
+ */
+
+#include "Replayer.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <thread>
+#include <vector>
+
+struct ReplayTask {
+    std::filesystem::path output_path;
+    const Simulator::HouseValues* hv = nullptr; // null when the house file is missing or invalid
+    std::string verdict = "";
+    std::string message = "";
+    std::size_t claimed_score = 0;
+    std::size_t replayed_score = 0;
+};
+
+// runs job(i) for every i < n on num_threads threads, each thread takes the next index from a shared counter
+template <typename Job>
+void parallel_for(std::size_t n, std::size_t num_threads, Job job) {
+    std::atomic<std::size_t> counter(0);
+    std::vector<std::thread> threads;
+    num_threads = std::max<std::size_t>(1, std::min(num_threads, n));
+    threads.reserve(num_threads);
+    for (std::size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&]() {
+            std::size_t i;
+            while((i = counter++) < n)
+                job(i);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void validate_task(ReplayTask& task) {
+    Replayer::OutputValues ov;
+    if(!task.hv) {
+        task.verdict = "ERROR";
+        task.message = "no valid house file for this output";
+        return;
+    }
+    task.message = Replayer::readOutputFile(task.output_path, ov);
+    if(!task.message.empty()) {
+        task.verdict = "ERROR";
+        return;
+    }
+    Replayer::ReplayResults rr;
+    task.message = Replayer::validate(*task.hv, ov, rr);
+    task.claimed_score = ov.score;
+    task.replayed_score = rr.score;
+    task.verdict = task.message.empty() ? (ov.score == rr.score ? "OK" : "OK_TIMEOUT") : "INVALID";
+}
+
+std::string csv_field(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c : s)
+        quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+    return quoted + "\"";
+}
+
+int print_tasks(const std::vector<ReplayTask>& tasks) {
+    std::size_t invalid = 0;
+    std::cout << "output,verdict,claimed_score,replayed_score,message\n";
+    for (const auto& task : tasks) {
+        std::cout << task.output_path.filename().string() << "," << task.verdict << "," << task.claimed_score << ","
+                  << task.replayed_score << "," << csv_field(task.message) << "\n";
+        invalid += task.verdict != "OK" && task.verdict != "OK_TIMEOUT";
+    }
+    std::cerr << tasks.size() - invalid << " of " << tasks.size() << " output files are valid" << std::endl;
+    return invalid ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int replay_steps(const Simulator::HouseValues& hv, const std::string& steps) {
+    Replayer::ReplayResults rr = Replayer::replay(hv, steps);
+    if(!rr.error_message.empty()) {
+        std::cout << "Invalid steps: " << rr.error_message << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "NumSteps = " << rr.num_steps << std::endl;
+    std::cout << "DirtLeft = " << rr.dirt_left << std::endl;
+    std::cout << "Status = " << rr.status << std::endl;
+    std::cout << "InDock = " << (rr.in_dock ? "TRUE" : "FALSE") << std::endl;
+    std::cout << "Score = " << rr.score << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int replay_directory(const std::filesystem::path& house_dir, const std::filesystem::path& results_dir, std::size_t num_threads) {
+    std::vector<ReplayTask> tasks;
+    std::map<std::string, Simulator::HouseValues> houses; // by house name, filled before any replay starts
+    try {
+        for (const auto& entry : std::filesystem::directory_iterator(results_dir)) {
+            std::string name = entry.path().stem().string();
+            std::size_t dash = name.rfind('-');
+            if(!entry.is_regular_file() || entry.path().extension() != ".txt" || dash == std::string::npos)
+                continue;
+            tasks.push_back({entry.path()});
+            houses.emplace(name.substr(0, dash), Simulator::HouseValues());
+        }
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Filesystem error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::pair<const std::string, Simulator::HouseValues>*> house_entries;
+    for (auto& entry : houses)
+        house_entries.push_back(&entry);
+    parallel_for(house_entries.size(), num_threads, [&](std::size_t i) {
+        house_entries[i]->second = Simulator::readHouseFile(house_dir / (house_entries[i]->first + ".house"));
+    });
+
+    for (auto& task : tasks) {
+        std::string name = task.output_path.stem().string();
+        const Simulator::HouseValues& hv = houses.at(name.substr(0, name.rfind('-')));
+        task.hv = hv.error_message.empty() ? &hv : nullptr;
+    }
+    parallel_for(tasks.size(), num_threads, [&](std::size_t i) { validate_task(tasks[i]); });
+
+    std::sort(tasks.begin(), tasks.end(), [](const ReplayTask& a, const ReplayTask& b) { return a.output_path < b.output_path; });
+    return print_tasks(tasks);
+}
+
+int main(int argc, char** argv) {
+    std::regex arg_pattern(R"(-(\w+)=(.*))");
+    std::map<std::string, std::string> args;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::smatch matches;
+        if(!std::regex_match(arg, matches, arg_pattern)) {
+            std::cerr << "Invalid argument: " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        args[matches[1]] = matches[2];
+    }
+
+    if(args.count("house_path") && args.count("results_path")) {
+        std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+        if(args.count("num_threads")) {
+            try {
+                num_threads = std::stoull(args["num_threads"]);
+            } catch (std::exception& e) {
+                std::cerr << "Error: Invalid number format" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        return replay_directory(args["house_path"], args["results_path"], num_threads);
+    }
+
+    if(!args.count("house") || (args.count("steps") == args.count("output"))) {
+        std::cerr << "Usage: myreplay -house=FILE (-steps=STEPS | -output=FILE) | -house_path=DIR -results_path=DIR [-num_threads=N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Simulator::HouseValues hv = Simulator::readHouseFile(args["house"]);
+    if(!hv.error_message.empty()) {
+        std::cerr << "Error in house file: " << hv.error_message << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(args.count("steps")) {
+        return replay_steps(hv, args["steps"]);
+    }
+
+    std::vector<ReplayTask> tasks = {{args["output"], &hv}};
+    validate_task(tasks[0]);
+    return print_tasks(tasks);
+}
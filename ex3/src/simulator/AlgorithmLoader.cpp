@@ -0,0 +1,99 @@
+/**
+ * @file AlgorithmLoader.cpp
+ * @brief Implementation file for the AlgorithmLoader class.
+ */
+#include "AlgorithmLoader.h"
+#include <algorithm>
+#include <dlfcn.h>
+
+AlgorithmLoader::~AlgorithmLoader() {
+    unload();
+}
+
+std::string AlgorithmLoader::load(const std::filesystem::path& path) {
+    AlgorithmRegistrar& registrar = AlgorithmRegistrar::getAlgorithmRegistrar();
+    // algorithms compiled into the program (myrobot-static) were registered before any plugin
+    if(handles.empty())
+        builtin_count = registrar.count();
+    std::size_t registered = registrar.count();
+    // the factories are kept once, as registered, so registering them again doesn't wrap them again
+    for(auto it = registrar.begin() + registered_factories.size(); it != registrar.end(); it++) {
+        auto algo = *it;
+        registered_factories.emplace_back(algo.name(), [algo]() { return algo.create(); });
+    }
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if(!handle) {
+        return "Failed to open library: " + std::string(dlerror());
+    }
+
+    // Clear any existing errors
+    dlerror();
+
+    // a second algorithm with the same name would overwrite the first one's output files
+    auto added = registrar.begin() + registered;
+    for (auto it = added; it != registrar.end(); it++) {
+        if(std::find_if(registrar.begin(), added, [&it](const auto& algo) { return algo.name() == it->name(); }) != added) {
+            std::string name = it->name();
+            truncateRegistrar(registered);
+            dlclose(handle);
+            return "Algorithm " + name + " is already registered";
+        }
+    }
+
+    handles.push_back(handle);
+    registered_paths.resize(registered);
+    registered_paths.resize(registrar.count(), path);
+
+    // every plugin registers exactly one algorithm when it's loaded
+    if(registrar.count() != registered + 1) {
+        return "Failed to register algorithm";
+    }
+    return "";
+}
+
+std::vector<AlgorithmLoader::LoadError> AlgorithmLoader::load(const std::vector<std::filesystem::path>& paths) {
+    std::vector<LoadError> errors;
+    for (const auto& path : paths)
+    {
+        std::string err = load(path);
+        if(err != "")
+            errors.push_back({path, err});
+    }
+    return errors;
+}
+
+std::vector<AlgorithmEntry> AlgorithmLoader::getAlgorithms() const {
+    std::vector<AlgorithmEntry> algorithms;
+    size_t i = 0;
+    for(const auto& algo: AlgorithmRegistrar::getAlgorithmRegistrar()) {
+        algorithms.push_back({algo.name(), [algo]() { return algo.create(); }, i < registered_paths.size() ? registered_paths[i] : ""});
+        i++;
+    }
+    return algorithms;
+}
+
+void AlgorithmLoader::truncateRegistrar(std::size_t count) {
+    AlgorithmRegistrar& registrar = AlgorithmRegistrar::getAlgorithmRegistrar();
+    if(count >= registrar.count())
+        return;
+    registered_factories.resize(count);
+    registrar.clear();
+    for(const auto& [name, factory] : registered_factories)
+        registrar.registerAlgorithm(name, factory);
+}
+
+std::string AlgorithmLoader::unload() {
+    if(handles.empty())
+        return "";
+
+    truncateRegistrar(builtin_count);
+    registered_paths.resize(builtin_count);
+    std::string err = "";
+    for(auto handle : handles) {
+        if(dlclose(handle) && err == "") {
+            err = "Failed to close library: " + std::string(dlerror());
+        }
+    }
+    handles.clear();
+    return err;
+}
@@ -0,0 +1,85 @@
+#ifndef ALGORITHM_LOADER_H
+#define ALGORITHM_LOADER_H
+
+/**
+ * @file AlgorithmLoader.h
+ * @brief This file contains the declaration of the AlgorithmLoader class, which loads algorithm plugins (.so files).
+ */
+
+#include "../common/AlgorithmRegistrar.h"
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief An algorithm that can be run by the BatchRunner: its name and a factory creating instances of it.
+ */
+struct AlgorithmEntry {
+    std::string name;
+    AlgorithmFactory factory;
+    std::filesystem::path plugin_path = ""; /**< The .so file that registered the algorithm, empty if it's not a plugin. */
+};
+
+/**
+ * @brief The AlgorithmLoader class dlopens algorithm plugins, which register themselves in the AlgorithmRegistrar,
+ * and keeps them loaded until unload() is called (or the loader is destroyed).
+ * Algorithms compiled into the program register themselves before main, they're listed with the plugins' and stay registered.
+ */
+class AlgorithmLoader {
+public:
+    /**
+     * @brief A plugin that failed to load.
+     */
+    struct LoadError {
+        std::filesystem::path path;
+        std::string message;
+    };
+
+    AlgorithmLoader() = default;
+    AlgorithmLoader(const AlgorithmLoader&) = delete;
+    AlgorithmLoader& operator=(const AlgorithmLoader&) = delete;
+    ~AlgorithmLoader();
+
+    /**
+     * @brief Loads a single plugin.
+     * @param path The path of the .so file.
+     * @return An error message, empty on success.
+     */
+    std::string load(const std::filesystem::path& path);
+
+    /**
+     * @brief Loads the given plugins.
+     * @param paths The paths of the .so files.
+     * @return The plugins that failed to load.
+     */
+    std::vector<LoadError> load(const std::vector<std::filesystem::path>& paths);
+
+    /**
+     * @brief Gets the algorithms compiled into the program and those registered by the loaded plugins, in load order.
+     * The factories are only valid until unload() is called.
+     * @return The registered algorithms.
+     */
+    std::vector<AlgorithmEntry> getAlgorithms() const;
+
+    /**
+     * @brief Removes the plugins' algorithms from the registrar and dlcloses all the plugins. All their algorithm instances must be destroyed before.
+     * @return An error message, empty on success.
+     */
+    std::string unload();
+
+private:
+    /**
+     * @brief Drops the algorithms registered after the first count ones. The registrar (the project's skeleton) can only be cleared,
+     * so it's cleared and the kept algorithms are registered again, in the same order.
+     * @param count The number of algorithms to keep.
+     */
+    void truncateRegistrar(std::size_t count);
+
+    std::vector<void*> handles;
+    std::vector<std::pair<std::string, AlgorithmFactory>> registered_factories; /**< The algorithms in the registrar before the last load, to register again by truncateRegistrar(). */
+    std::vector<std::filesystem::path> registered_paths; /**< The plugin of every algorithm in the registrar, by registrar order. */
+    std::size_t builtin_count = 0; /**< The algorithms compiled into the program, they come first in the registrar and are never unloaded. */
+};
+
+#endif // ALGORITHM_LOADER_H
@@ -0,0 +1,327 @@
+/**
+ * @file BatchRunner.cpp
+ * @brief Implementation file for the BatchRunner class.
+ */
+#include "BatchRunner.h"
+#include "TaskArena.h"
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+// the process' peak resident set size so far (in KB), it only grows so it bounds the memory used by every task that finished before
+static long getPeakRssKb() {
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_maxrss;
+}
+
+// the CPUs the process may run on (set by taskset or a cpuset cgroup)
+static std::vector<int> getAllowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) != 0)
+        return cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if(CPU_ISSET(cpu, &set))
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// the cgroup CPU quota in CPUs (cgroup v2 cpu.max, or v1 cfs quota and period), 0 if there's no quota
+static std::size_t getCgroupCpuQuota() {
+    long long quota = -1, period = 0;
+    std::ifstream cpu_max("/sys/fs/cgroup/cpu.max");
+    std::string quota_str;
+    if(cpu_max >> quota_str >> period) {
+        if(quota_str == "max")
+            return 0;
+        try {
+            quota = std::stoll(quota_str);
+        } catch (const std::exception& e) {
+            return 0;
+        }
+    }
+    else {
+        std::ifstream quota_file("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        std::ifstream period_file("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if(!(quota_file >> quota) || !(period_file >> period))
+            return 0;
+    }
+    if(quota <= 0 || period <= 0)
+        return 0;
+    return std::max<std::size_t>(1, std::ceil(double(quota) / period));
+}
+
+std::size_t BatchRunner::defaultThreadCount() {
+    std::size_t count = std::thread::hardware_concurrency();
+    std::size_t allowed = getAllowedCpus().size();
+    if(allowed && (!count || allowed < count))
+        count = allowed;
+    std::size_t quota = getCgroupCpuQuota();
+    if(quota && (!count || quota < count))
+        count = quota;
+    return std::max<std::size_t>(1, count);
+}
+
+// splitmix64, spreads close inputs (like consecutive run numbers) over the whole range
+static std::uint64_t mixSeed(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// FNV-1a
+static std::uint64_t hashName(const std::string& name) {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+std::uint64_t BatchRunner::deriveSeed(std::uint64_t base, const std::string& house, const std::string& algorithm, std::size_t run) {
+    std::uint64_t seed = mixSeed(base ^ hashName(house));
+    seed = mixSeed(seed ^ hashName(algorithm));
+    return mixSeed(seed + run);
+}
+
+BatchRunner::BatchRunner(const std::vector<Simulator::HouseValues>& houses, const std::vector<AlgorithmEntry>& algorithms, BatchOptions options)
+    : houses(houses), algorithms(algorithms), options(std::move(options)),
+      num_threads(this->options.num_threads ? this->options.num_threads : defaultThreadCount()),
+      progress(std::make_unique<WorkerProgress[]>(num_threads)) {}
+
+std::vector<BatchRunner::Task> BatchRunner::crossProduct(std::size_t houses_num, std::size_t algorithms_num) {
+    std::vector<Task> tasks;
+    tasks.reserve(houses_num * algorithms_num);
+    for (std::size_t i = 0; i < houses_num; i++) {
+        for (std::size_t j = 0; j < algorithms_num; j++) {
+            tasks.push_back({i, j});
+        }
+    }
+    return tasks;
+}
+
+std::vector<TaskResult> BatchRunner::run(const std::vector<Task>& tasks) {
+    this->tasks = &tasks;
+    results.assign(tasks.size(), TaskResult());
+    counter = 0;
+    idle_starts.clear();
+    for (std::size_t i = 0; i < num_threads; i++) {
+        progress[i].tasks_done = 0;
+        progress[i].timeouts = 0;
+        progress[i].errors = 0;
+        progress[i].busy_us = 0;
+    }
+    tasks_total = tasks.size();
+
+    std::vector<int> cpus = options.affinity ? getAllowedCpus() : std::vector<int>();
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+
+    // creating the actual working threads (that run our tasks)
+    for (std::size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back(&BatchRunner::runWorker, this, i, std::cref(cpus));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // a thread is idle from running out of tasks until the whole batch is done
+    if(options.trace) {
+        auto end = TraceRecorder::Clock::now();
+        for (const auto& idle_start : idle_starts) {
+            options.trace->addSpan(idle_start.first, "idle", "idle", idle_start.second, end);
+        }
+    }
+
+    this->tasks = nullptr;
+    return std::move(results);
+}
+
+BatchRunner::Progress BatchRunner::getProgress() const {
+    Progress snapshot;
+    snapshot.tasks_total = tasks_total;
+    for (std::size_t i = 0; i < num_threads; i++) {
+        snapshot.tasks_done += progress[i].tasks_done.load(std::memory_order_relaxed);
+        snapshot.timeouts += progress[i].timeouts.load(std::memory_order_relaxed);
+        snapshot.errors += progress[i].errors.load(std::memory_order_relaxed);
+        snapshot.busy.push_back(std::chrono::microseconds(progress[i].busy_us.load(std::memory_order_relaxed)));
+    }
+    return snapshot;
+}
+
+// called with the task's results mutex locked, exactly once per task
+void BatchRunner::finishTask(std::size_t task_index, std::size_t worker, Simulator& simulator, const std::string& error_message, std::chrono::microseconds duration) {
+    TaskResult& result = results[task_index];
+    result.num_steps = simulator.getNumSteps();
+    result.dirt_left = simulator.getDirtLeft();
+    result.in_dock = simulator.isInDock();
+    result.duration = duration;
+    result.peak_rss_kb = getPeakRssKb();
+    if(MemoryAccount::isAvailable())
+        result.algorithm_peak_bytes = simulator.getAlgorithmPeakBytes();
+
+    result.status = simulator.getStatus();
+
+    if(error_message != "") {
+        // a failed task gets the same default score as a timed out one
+        simulator.rres.timeout_reached = true;
+        result.error_message = error_message;
+    }
+    else {
+        result.timeout_reached = simulator.rres.timeout_reached;
+        if(!result.timeout_reached) {
+            result.algorithm_counts = simulator.rres.algorithm_counts;
+            result.simulator_counts = simulator.rres.simulator_counts;
+            result.sensor_stats = simulator.rres.sensor_stats;
+            result.step_p50 = simulator.rres.step_latency.getPercentile(50);
+            result.step_p99 = simulator.rres.step_latency.getPercentile(99);
+        }
+        if(options.record_steps)
+            result.steps.assign(simulator.rres.steps_taken.begin(), simulator.rres.steps_taken.end());
+        if(options.record_log)
+            result.log.assign(simulator.rres.log_info.begin(), simulator.rres.log_info.end());
+    }
+    result.score = simulator.calcScore();
+
+    if(options.on_task_done) {
+        TraceRecorder::Span span(options.trace, "write " + getTaskLabel(task_index), "write");
+        options.on_task_done(task_index, result);
+    }
+
+    // counted in the slot of the worker that started the task, also when its backup thread finishes it
+    WorkerProgress& slot = progress[worker];
+    slot.tasks_done.fetch_add(1, std::memory_order_relaxed);
+    if(error_message != "")
+        slot.errors.fetch_add(1, std::memory_order_relaxed);
+    else if(result.timeout_reached)
+        slot.timeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+// the task's name in the trace
+std::string BatchRunner::getTaskLabel(std::size_t task_index) const {
+    const Task& task = (*tasks)[task_index];
+    return houses[task.house_index].house_path.stem().string() + "-" + algorithms[task.algorithm_index].name;
+}
+
+// pins the worker before it runs any task, so everything its tasks allocate is first touched on the worker's CPU.
+// the backup timeout threads it creates inherit its affinity, so a thread that replaces it stays on the same CPU
+void BatchRunner::runWorker(std::size_t worker, const std::vector<int>& cpus) {
+    if(!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[worker % cpus.size()], &set);
+        // pinning is only a placement hint, a worker that can't be pinned still runs its tasks
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if(options.trace)
+        options.trace->setThreadName("worker " + std::to_string(worker));
+    runTasks(worker);
+}
+
+// this function is run by every thread that runs tasks (task is a house&algorithm combination)
+void BatchRunner::runTasks(std::size_t worker) {
+    std::size_t my_task;
+    std::mutex results_mutex;
+    std::deque<std::jthread> timeout_threads;
+    // per-thread counters, a backup thread that takes over opens its own
+    PerfCounters perf_counters;
+    bool perf_counters_open = options.perf_counters && perf_counters.open();
+    // reused by all the thread's tasks, a backup thread that takes over has its own (the timed out task may still be using this one)
+    TaskArena arena;
+    Simulator simulator(arena.getResource());
+    // per algorithm, the instance the thread kept from its last task of it (null when there is none), reset for its next one
+    std::vector<std::unique_ptr<AbstractAlgorithm>> spare_algorithms(algorithms.size());
+    while((my_task = counter++) < tasks->size()) {
+        const Task& task = (*tasks)[my_task];
+        // everything the last task allocated in the simulator is freed in one go
+        simulator.reset();
+        arena.release();
+        simulator.setHouseValues(houses[task.house_index]);
+        if(task.max_steps)
+            simulator.setMaxSteps(*task.max_steps);
+        if(task.battery)
+            simulator.setBatteryCapacity(*task.battery);
+        simulator.setRecordLog(options.record_log);
+        simulator.setMemoryLimit(options.memory_limit);
+        simulator.setProfileSensors(options.profile_sensors);
+        simulator.setProfileSteps(options.profile_steps);
+        if(perf_counters_open)
+            simulator.setPerfCounters(&perf_counters);
+        std::unique_ptr<AbstractAlgorithm>& spare = spare_algorithms[task.algorithm_index];
+        if(!spare || !simulator.reuseAlgorithm(std::move(spare)))
+            simulator.setAlgorithm(algorithms[task.algorithm_index].factory());
+        simulator.setAlgorithmName(algorithms[task.algorithm_index].name);
+        if(task.seed)
+            simulator.setAlgorithmSeed(*task.seed);
+
+        auto timeout = std::chrono::milliseconds(simulator.getMaxSteps());
+        auto start = std::chrono::steady_clock::now();
+
+        // create a backup timeout thread
+        timeout_threads.emplace_back([this, my_task, worker, &simulator, timeout, &results_mutex](std::stop_token stop) {
+            // the sleep ends early once the task is done, so a batch never waits out the timeouts of tasks that finished
+            std::mutex sleep_mutex;
+            std::condition_variable_any sleep_cv;
+            std::unique_lock<std::mutex> sleep_lock(sleep_mutex);
+            sleep_cv.wait_for(sleep_lock, stop, timeout, []() { return false; });
+            if(stop.stop_requested())
+                return;
+            std::unique_lock<std::mutex> lck(results_mutex);
+            if(results[my_task].score == -1) {
+                simulator.rres.timeout_reached = true;
+                finishTask(my_task, worker, simulator, "", timeout);
+                lck.unlock(); // this line is important
+                if(options.trace) {
+                    options.trace->setThreadName("backup of " + getTaskLabel(my_task));
+                    options.trace->addInstant("timeout takeover " + getTaskLabel(my_task), "timeout");
+                }
+                // the backup thread effectively replaces the original task thread here by running tasks instead of it
+                runTasks(worker);
+            }
+        });
+
+        std::string err = simulator.run();
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        std::lock_guard<std::mutex> lock(results_mutex);
+        if(options.trace) {
+            options.trace->addSpan(options.trace->getThreadId(), getTaskLabel(my_task) + (simulator.rres.timeout_reached ? " (timed out)" : ""),
+                                   "run", start, end);
+        }
+        // equivalent to saying "if nobody written this task's score yet"
+        if(results[my_task].score == -1) {
+            // we usually reach here
+            finishTask(my_task, worker, simulator, err, duration);
+            timeout_threads.back().request_stop();
+            // only an algorithm that ran to its end is reset for the next task
+            if(err == "" && !simulator.rres.timeout_reached) {
+                spare = simulator.releaseAlgorithm();
+                if(!Simulator::getResettable(*spare))
+                    spare.reset();
+            }
+            auto busy = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            progress[worker].busy_us.fetch_add(busy.count(), std::memory_order_relaxed);
+        }
+        else {
+            // we only reach here when the simulator finished after timeout and another thread replaced the current thread
+            progress[worker].busy_us.fetch_add(duration.count(), std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    if(options.trace) {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        idle_starts.push_back({options.trace->getThreadId(), TraceRecorder::Clock::now()});
+    }
+}
@@ -0,0 +1,176 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+/**
+ * @file BatchRunner.h
+ * @brief This file contains the declaration of the BatchRunner class, which runs house&algorithm tasks on a pool of threads.
+ */
+
+#include "Simulator.h"
+#include "AlgorithmLoader.h"
+#include "TraceRecorder.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The results of a single house&algorithm task, entirely in memory.
+ */
+struct TaskResult {
+    int score = -1; /**< -1 until the task is done. */
+    std::string status = ""; /**< FINISHED, WORKING or DEAD, like the output file. */
+    bool timeout_reached = false; /**< The task got the default score after running for too long. */
+    std::size_t num_steps = 0; /**< Not counting the Finish step, like the output file. */
+    std::size_t dirt_left = 0;
+    bool in_dock = false;
+    std::string error_message = ""; /**< Set when the algorithm threw an exception, the task then gets the timeout score. */
+    std::string steps = ""; /**< The steps string, when BatchOptions::record_steps is set. */
+    std::string log = ""; /**< The step by step log, when BatchOptions::record_log is set. */
+    std::chrono::microseconds duration{0};
+    long peak_rss_kb = 0; /**< The process' peak RSS when the task was done. */
+    std::optional<std::size_t> algorithm_peak_bytes; /**< The peak heap memory held by the algorithm, see Simulator::getAlgorithmPeakBytes, empty unless MemoryAccount::isAvailable. */
+    PerfCounters::Counts algorithm_counts; /**< With BatchOptions::perf_counters, unavailable for timed out and failed tasks. */
+    PerfCounters::Counts simulator_counts;
+    std::array<Simulator::SensorStats, Simulator::SENSORS_NUM> sensor_stats; /**< With BatchOptions::profile_sensors, empty for timed out and failed tasks. */
+    std::chrono::nanoseconds step_p50{0}; /**< With BatchOptions::profile_steps, 0 for timed out and failed tasks. */
+    std::chrono::nanoseconds step_p99{0};
+
+    /**
+     * @brief Gets a status that also tells timed out and failed tasks apart.
+     * @return ERROR, TIMEOUT or the simulator's status.
+     */
+    std::string getOutcome() const {
+        return error_message != "" ? "ERROR" : (timeout_reached ? "TIMEOUT" : status);
+    }
+};
+
+/**
+ * @brief Options of a batch run.
+ */
+struct BatchOptions {
+    std::size_t num_threads = 0; /**< 0 for BatchRunner::defaultThreadCount(). */
+    /**
+     * @brief Pins every worker thread to its own CPU (round robin over the CPUs the process may run on).
+     * A task copies its house on its worker thread, so with pinned workers the copy is first touched, and allocated, on the worker's NUMA node.
+     */
+    bool affinity = false;
+    bool record_steps = false;
+    bool record_log = false;
+    bool perf_counters = false; /**< Counts every task with the PerfCounters of its worker thread. */
+    bool profile_sensors = false; /**< Counts every algorithm's sensor calls, see Simulator::setProfileSensors. */
+    bool profile_steps = false; /**< Times every step of every task, see Simulator::setProfileSteps. */
+    std::size_t memory_limit = 0; /**< The heap memory an algorithm may hold in a task (bytes, 0 for no limit), going over it fails the task. Only enforced if MemoryAccount::isAvailable. */
+    TraceRecorder* trace = nullptr; /**< Records every task's run and write phases, timeout takeovers and the idle time of every thread. */
+    /**
+     * @brief Called by the worker thread as soon as a task is done (and before the thread takes another task).
+     * It may move the steps and log out of the result, so they aren't kept in memory until the batch ends.
+     */
+    std::function<void(std::size_t task_index, TaskResult& result)> on_task_done;
+};
+
+/**
+ * @brief The BatchRunner class runs a list of house&algorithm tasks on num_threads threads and collects their results.
+ * It doesn't touch the filesystem, houses are given as HouseValues and algorithms as factories.
+ */
+class BatchRunner {
+public:
+    /**
+     * @brief A snapshot of a running batch, see getProgress.
+     */
+    struct Progress {
+        std::size_t tasks_total = 0;
+        std::size_t tasks_done = 0;
+        std::size_t timeouts = 0;
+        std::size_t errors = 0;
+        std::vector<std::chrono::microseconds> busy; /**< Per worker, the time it spent running and writing tasks. */
+    };
+
+    struct Task {
+        std::size_t house_index;
+        std::size_t algorithm_index;
+        std::optional<std::uint64_t> seed = std::nullopt; /**< Passed to a SeedableAlgorithm, unset leaves the algorithm to seed itself. */
+        std::optional<std::size_t> max_steps = std::nullopt; /**< Overrides the house's MaxSteps. */
+        std::optional<std::size_t> battery = std::nullopt; /**< Overrides the house's MaxBattery. */
+    };
+
+    /**
+     * @brief Constructs a BatchRunner. The houses and algorithms must outlive the runner.
+     * @param houses The (valid) houses.
+     * @param algorithms The algorithms.
+     * @param options The batch options.
+     */
+    BatchRunner(const std::vector<Simulator::HouseValues>& houses, const std::vector<AlgorithmEntry>& algorithms, BatchOptions options = {});
+
+    /**
+     * @brief Creates a task for every house&algorithm combination, grouped by house.
+     * @param houses_num The number of houses.
+     * @param algorithms_num The number of algorithms.
+     * @return The tasks, task house_index * algorithms_num + algorithm_index runs that house with that algorithm.
+     */
+    static std::vector<Task> crossProduct(std::size_t houses_num, std::size_t algorithms_num);
+
+    /**
+     * @brief Gets the number of CPUs the process can actually use: the smallest of std::thread::hardware_concurrency(),
+     * the CPUs in its affinity mask and its cgroup CPU quota (rounded up).
+     * @return The number of CPUs, at least 1.
+     */
+    static std::size_t defaultThreadCount();
+
+    /**
+     * @brief Derives a task's seed, it depends only on its arguments, so it doesn't change with the number of threads
+     * or with the other houses and algorithms in the batch.
+     * @param base The base seed of the batch.
+     * @param house The house name.
+     * @param algorithm The algorithm name.
+     * @param run The run number of a multi-seed pair, 0 for a single run.
+     * @return The task's seed.
+     */
+    static std::uint64_t deriveSeed(std::uint64_t base, const std::string& house, const std::string& algorithm, std::size_t run);
+
+    /**
+     * @brief Runs the tasks and waits for all of them.
+     * @param tasks The tasks to run.
+     * @return The results, in the order of the tasks.
+     */
+    std::vector<TaskResult> run(const std::vector<Task>& tasks);
+
+    /**
+     * @brief Gets the progress of the batch, may be called from another thread while run is running.
+     * Every worker only counts into its own slot, so the workers never wait for each other (or for this) to count.
+     * @return The progress so far.
+     */
+    Progress getProgress() const;
+
+private:
+    const std::vector<Simulator::HouseValues>& houses;
+    const std::vector<AlgorithmEntry>& algorithms;
+    BatchOptions options;
+    const std::vector<Task>* tasks = nullptr;
+    std::vector<TaskResult> results;
+    std::atomic<std::size_t> counter{0};
+
+    // a cache line per worker, so counting never makes two workers share a line
+    struct alignas(64) WorkerProgress {
+        std::atomic<std::size_t> tasks_done{0};
+        std::atomic<std::size_t> timeouts{0};
+        std::atomic<std::size_t> errors{0};
+        std::atomic<std::int64_t> busy_us{0};
+    };
+    std::size_t num_threads;
+    std::unique_ptr<WorkerProgress[]> progress;
+    std::atomic<std::size_t> tasks_total{0};
+    std::mutex idle_mutex;
+    std::vector<std::pair<int, TraceRecorder::Clock::time_point>> idle_starts; // when each thread ran out of tasks, for the trace
+
+    std::string getTaskLabel(std::size_t task_index) const;
+    void runWorker(std::size_t worker, const std::vector<int>& cpus);
+    void runTasks(std::size_t worker);
+    void finishTask(std::size_t task_index, std::size_t worker, Simulator& simulator, const std::string& error_message, std::chrono::microseconds duration);
+};
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,56 @@
+/**
+ * @file Battery.cpp
+ * @brief Implementation file for the Battery class.
+ */
+#include "Battery.h"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+std::int64_t Battery::toTwentieths(std::size_t capacity) {
+    if(capacity > MAX_CAPACITY)
+        throw std::out_of_range("Battery capacity " + std::to_string(capacity) + " is over " + std::to_string(MAX_CAPACITY));
+    return static_cast<std::int64_t>(capacity) * UNITS;
+}
+
+Battery::Battery(std::size_t capacity) : capacity(toTwentieths(capacity)), left(this->capacity) {}
+
+// capacity/20 units are capacity twentieths
+void Battery::charge() {
+    left = std::min(capacity, left + capacity / UNITS);
+}
+
+void Battery::discharge() {
+    if(left == 0) {
+        // We shouldn't reach here
+        throw std::runtime_error("Battery is dead and cannot perform the requested move!");
+    }
+    left -= UNITS;
+}
+
+bool Battery::isEmpty() const {
+    return left == 0;
+}
+
+bool Battery::isDepleted() const {
+    return left <= 0;
+}
+
+std::size_t Battery::getState() const {
+    return left <= 0 ? 0 : static_cast<std::size_t>(left / UNITS);
+}
+
+// a twentieth is 0.05, so the level has two decimals at most
+void Battery::appendTo(std::pmr::string& text) const {
+    std::int64_t magnitude = left < 0 ? -left : left;
+    std::int64_t hundredths = magnitude % UNITS * (100 / UNITS);
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), magnitude / UNITS).ptr;
+    if(left < 0)
+        text += '-';
+    text.append(digits, end);
+    text += '.';
+    text += static_cast<char>('0' + hundredths / 10);
+    text += static_cast<char>('0' + hundredths % 10);
+    text += "0000";
+}
@@ -0,0 +1,69 @@
+#ifndef BATTERY_H
+#define BATTERY_H
+
+/**
+ * @file Battery.h
+ * @brief This file contains the declaration of the Battery class, the robot's battery as the simulator (and the replayer) keep it.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+/**
+ * @brief The Battery class keeps the battery level in twentieths of a unit, since a step at the docking station charges capacity/20 units,
+ * so charging and moving are exact integer additions at any capacity (up to MAX_CAPACITY).
+ * The level may go below 0: a robot that leaves the docking station with less than a unit left still makes its move (only an empty battery stops it).
+ */
+class Battery {
+public:
+    /**
+     * @brief The largest capacity whose twentieths fit in the level, larger ones must be rejected where they're read.
+     */
+    static constexpr std::size_t MAX_CAPACITY = INT64_MAX / 20; // 20 twentieths per unit
+
+    /**
+     * @throws std::out_of_range if the capacity is over MAX_CAPACITY.
+     */
+    Battery(std::size_t capacity = 0);
+
+    /**
+     * @brief Adds capacity/20 units, up to the capacity.
+     */
+    void charge();
+
+    /**
+     * @brief Takes one unit for a move (or a cleaning step).
+     * @throws std::runtime_error if the battery is empty.
+     */
+    void discharge();
+
+    /**
+     * @brief Tells whether the level is exactly 0, the robot can't move then.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Tells whether the level is 0 or below, for the status and the score.
+     */
+    bool isDepleted() const;
+
+    /**
+     * @brief Gets the whole units left, what the battery meter shows (0 below 0).
+     */
+    std::size_t getState() const;
+
+    /**
+     * @brief Appends the level with six decimals, for the log (without a temporary string).
+     */
+    void appendTo(std::pmr::string& text) const;
+
+private:
+    static constexpr std::int64_t UNITS = 20; // twentieths per battery unit
+    static std::int64_t toTwentieths(std::size_t capacity);
+    std::int64_t capacity; // in twentieths
+    std::int64_t left; // in twentieths
+};
+
+#endif // BATTERY_H
@@ -60,6 +60,8 @@ bool House::Tile::isWall() const
 }
 
 
+House::Matrix::Matrix(std::pmr::memory_resource* memory) : vec(memory), dim_x(0), dim_y(0) {}
+
 House::Matrix::Matrix(size_t dim_x, size_t dim_y) : dim_x(dim_x), dim_y(dim_y) {
     vec.resize(this->dim_x * this->dim_y, Tile(0));
 }
@@ -112,6 +114,8 @@ House::Tile House::Matrix::operator()(Coords location) const {
     return (*this)(location.x, location.y);
 }
 
+House::House(std::pmr::memory_resource* memory) : total_dirt(0), tiles(memory) {}
+
 House::House(Matrix tiles, Coords docking_station, size_t total_dirt): total_dirt(total_dirt), tiles(tiles), docking_station(docking_station) {}
 
 size_t House::getDirtLevel(Coords location) const {
@@ -144,6 +148,10 @@ size_t House::getTotalDirt() const {
 }
 
 void House::setTiles(Matrix&& tiles) {
+    this->tiles = std::move(tiles);
+}
+
+void House::setTiles(const Matrix& tiles) {
     this->tiles = tiles;
 }
 
@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <fstream>
 #include <string>
+#include <memory_resource>
 #include "../common_algo_sim/common.h"
 
 /**
@@ -60,7 +61,7 @@ public:
      */
     class Matrix
     {
-        std::vector<Tile> vec;
+        std::pmr::vector<Tile> vec;
         size_t dim_x;
         size_t dim_y;
 
@@ -129,6 +130,13 @@ public:
          */
         Matrix() {};
 
+        /**
+         * @brief Constructs an empty Matrix object whose tiles will be allocated from the given memory resource.
+         * A copy of the matrix uses the default resource, and copying another matrix into this one keeps this one's resource.
+         * @param memory The memory resource.
+         */
+        explicit Matrix(std::pmr::memory_resource* memory);
+
         /**
          * @brief Constructs a Matrix object with the given dimensions.
          * @param dim_x The number of columns.
@@ -183,6 +191,12 @@ public:
 
     House() {};
 
+    /**
+     * @brief Constructs an empty House object whose tiles will be allocated from the given memory resource (see Matrix).
+     * @param memory The memory resource.
+     */
+    explicit House(std::pmr::memory_resource* memory);
+
     /**
      * @brief Constructs a House object with the given matrix of tiles, docking station coordinates, and total dirt level.
      * @param tiles The matrix of tiles representing the house.
@@ -225,6 +239,11 @@ public:
 
     void setTiles(Matrix&& tiles);
 
+    /**
+     * @brief Copies the tiles into the house's own tiles, allocated from the house's memory resource.
+     */
+    void setTiles(const Matrix& tiles);
+
     void setDockingStation(Coords docking_station);
 
     void setTotalDirt(size_t total_dirt);
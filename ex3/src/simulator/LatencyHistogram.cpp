@@ -0,0 +1,51 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief Implementation file for the LatencyHistogram class.
+ */
+#include "LatencyHistogram.h"
+#include <bit>
+#include <cmath>
+
+int LatencyHistogram::getBucket(std::uint64_t ns) {
+    if(ns < LINEAR_BUCKETS)
+        return static_cast<int>(ns);
+    // the power of two, then the next SUB_BITS bits after the highest one
+    int exponent = std::bit_width(ns) - 1;
+    int sub_bucket = static_cast<int>(ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + (exponent - SUB_BITS - 1) * SUB_BUCKETS + sub_bucket;
+}
+
+// the highest value that falls in the bucket
+std::uint64_t LatencyHistogram::getBucketEnd(int bucket) {
+    if(bucket < LINEAR_BUCKETS)
+        return bucket;
+    int exponent = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS + SUB_BITS + 1;
+    std::uint64_t sub_bucket = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    std::uint64_t width = std::uint64_t(1) << (exponent - SUB_BITS);
+    return (SUB_BUCKETS + sub_bucket) * width + width - 1;
+}
+
+void LatencyHistogram::add(std::chrono::nanoseconds duration) {
+    counts[getBucket(duration.count() > 0 ? duration.count() : 0)]++;
+    count++;
+}
+
+std::size_t LatencyHistogram::getCount() const {
+    return count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(double percent) const {
+    if(count == 0)
+        return std::chrono::nanoseconds(0);
+    // the rank of the percentile, at least the first duration
+    std::size_t rank = static_cast<std::size_t>(std::ceil(percent / 100 * count));
+    if(rank == 0)
+        rank = 1;
+    std::size_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if(seen >= rank)
+            return std::chrono::nanoseconds(getBucketEnd(bucket));
+    }
+    return std::chrono::nanoseconds(getBucketEnd(BUCKETS - 1));
+}
@@ -0,0 +1,46 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+/**
+ * @file LatencyHistogram.h
+ * @brief This file contains the declaration of the LatencyHistogram class, which keeps the distribution of many short durations in a fixed size.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The LatencyHistogram class counts durations in log-linear buckets: every power of two of nanoseconds is split in SUB_BUCKETS
+ * equal buckets, so a percentile is known to within 1/SUB_BUCKETS of its value, whatever the number of durations.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+
+    void add(std::chrono::nanoseconds duration);
+
+    std::size_t getCount() const;
+
+    /**
+     * @brief Gets a percentile of the durations added.
+     * @param percent Between 0 and 100.
+     * @return The upper bound of the bucket the percentile falls in, 0 if nothing was added.
+     */
+    std::chrono::nanoseconds getPercentile(double percent) const;
+
+private:
+    // the values below 2*SUB_BUCKETS get a bucket each, then SUB_BUCKETS buckets per power of two up to 2^64
+    static constexpr int LINEAR_BUCKETS = 2 * SUB_BUCKETS;
+    static constexpr int BUCKETS = LINEAR_BUCKETS + (64 - (SUB_BITS + 1)) * SUB_BUCKETS;
+
+    std::array<std::size_t, BUCKETS> counts{};
+    std::size_t count = 0;
+
+    static int getBucket(std::uint64_t ns);
+    static std::uint64_t getBucketEnd(int bucket);
+};
+
+#endif // LATENCY_HISTOGRAM_H
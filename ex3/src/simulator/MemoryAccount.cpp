@@ -0,0 +1,65 @@
+/**
+ * @file MemoryAccount.cpp
+ * @brief Implementation file for the MemoryAccount class.
+ */
+#include "MemoryAccount.h"
+
+static thread_local MemoryAccount* current_account = nullptr;
+
+// defined by MemoryHooks.cpp, weak so the library links without it
+extern const bool vacuumsim_memory_hooks __attribute__((weak));
+
+bool MemoryAccount::isAvailable() {
+    return &vacuumsim_memory_hooks != nullptr;
+}
+
+MemoryAccount::Scope::Scope(MemoryAccount* account) : previous(current_account) {
+    current_account = account;
+}
+
+MemoryAccount::Scope::~Scope() {
+    current_account = previous;
+}
+
+void MemoryAccount::setLimit(std::size_t limit_bytes) {
+    this->limit_bytes = limit_bytes;
+}
+
+void MemoryAccount::reset() {
+    current_bytes.store(0, std::memory_order_relaxed);
+    peak_bytes.store(0, std::memory_order_relaxed);
+    limit_exceeded.store(false, std::memory_order_relaxed);
+}
+
+std::size_t MemoryAccount::getLimit() const {
+    return limit_bytes;
+}
+
+std::size_t MemoryAccount::getPeakBytes() const {
+    return peak_bytes.load(std::memory_order_relaxed);
+}
+
+bool MemoryAccount::isLimitExceeded() const {
+    return limit_exceeded.load(std::memory_order_relaxed);
+}
+
+bool MemoryAccount::allocated(std::size_t bytes) {
+    MemoryAccount* account = current_account;
+    if(!account)
+        return true;
+    std::int64_t current = account->current_bytes.load(std::memory_order_relaxed) + static_cast<std::int64_t>(bytes);
+    if(account->limit_bytes && current > static_cast<std::int64_t>(account->limit_bytes)) {
+        account->limit_exceeded.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    account->current_bytes.store(current, std::memory_order_relaxed);
+    if(current > account->peak_bytes.load(std::memory_order_relaxed))
+        account->peak_bytes.store(current, std::memory_order_relaxed);
+    return true;
+}
+
+void MemoryAccount::freed(std::size_t bytes) {
+    MemoryAccount* account = current_account;
+    if(account)
+        account->current_bytes.store(account->current_bytes.load(std::memory_order_relaxed) - static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+}
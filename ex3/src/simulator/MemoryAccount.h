@@ -0,0 +1,81 @@
+#ifndef MEMORY_ACCOUNT_H
+#define MEMORY_ACCOUNT_H
+
+/**
+ * @file MemoryAccount.h
+ * @brief This file contains the declaration of the MemoryAccount class, which counts the heap memory allocated by a thread for a while.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The MemoryAccount class counts the bytes allocated (with operator new) and freed by the threads it's attached to, and keeps their peak.
+ * The counting is done by the global operator new and delete of the program (MemoryHooks.cpp, which only myrobot links), which the dlopen'ed
+ * plugins use too, so it counts a plugin's containers without any change to the plugin. Memory taken with malloc directly isn't counted.
+ * Only the attached thread writes the counts, other threads may read them.
+ */
+class MemoryAccount {
+public:
+    /**
+     * @brief Attaches an account to the calling thread until the scope ends (and restores the thread's previous account).
+     */
+    class Scope {
+        MemoryAccount* previous;
+    public:
+        Scope(MemoryAccount* account);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+    };
+
+    /**
+     * @brief Sets the limit, an allocation that would take the account over it throws std::bad_alloc instead.
+     * @param limit_bytes The limit, 0 for none.
+     */
+    void setLimit(std::size_t limit_bytes);
+
+    /**
+     * @brief Sets the counts back to 0 (the limit stays), must not be called while a thread is attached.
+     */
+    void reset();
+
+    std::size_t getLimit() const;
+
+    /**
+     * @brief Gets the highest number of bytes the account had allocated at once.
+     */
+    std::size_t getPeakBytes() const;
+
+    /**
+     * @brief Tells whether an allocation was refused for the limit.
+     */
+    bool isLimitExceeded() const;
+
+    /**
+     * @brief Tells whether allocations are counted at all, which they are only in a program that links MemoryHooks.cpp.
+     * Otherwise the accounts stay at 0 and their limits aren't enforced.
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Counts an allocation of the calling thread in its account, if it has one. Called by operator new.
+     * @return false if the allocation would take the account over its limit, it isn't counted then.
+     */
+    static bool allocated(std::size_t bytes);
+
+    /**
+     * @brief Counts a free of the calling thread in its account, if it has one. Called by operator delete.
+     */
+    static void freed(std::size_t bytes);
+
+private:
+    // only the attached thread writes, so plain loads and stores are enough (no locked instruction per allocation)
+    std::atomic<std::int64_t> current_bytes{0}; // may go below 0 when memory allocated before the scope is freed in it
+    std::atomic<std::int64_t> peak_bytes{0};
+    std::atomic<bool> limit_exceeded{false};
+    std::size_t limit_bytes = 0;
+};
+
+#endif // MEMORY_ACCOUNT_H
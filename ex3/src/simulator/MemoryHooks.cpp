@@ -0,0 +1,50 @@
+/**
+ * @file MemoryHooks.cpp
+ * @brief The replacements of the global operator new and delete that count into MemoryAccount.
+ * They replace the allocator of the whole process, so only myrobot links them and libvacuumsim doesn't: a program that embeds the library
+ * keeps its own allocator, and gets no algo_peak_bytes (see MemoryAccount::isAvailable).
+ */
+#include "MemoryAccount.h"
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+// MemoryAccount::isAvailable looks for it
+extern const bool vacuumsim_memory_hooks = true;
+
+// The replacements of the global operator new and delete. A block is counted by its usable size, which delete can get back without a header.
+// The nothrow forms call these, and the over-aligned forms are left to the standard library (they aren't counted).
+
+void* operator new(std::size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if(!ptr)
+        throw std::bad_alloc();
+    if(!MemoryAccount::allocated(malloc_usable_size(ptr))) {
+        std::free(ptr);
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    if(!ptr)
+        return;
+    MemoryAccount::freed(malloc_usable_size(ptr));
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file PerfCounters.cpp
+ * @brief Implementation file for the PerfCounters class.
+ */
+#include "PerfCounters.h"
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+PerfCounters::Counts& PerfCounters::Counts::operator+=(const Counts& other) {
+    for (int i = 0; i < COUNTERS_NUM; i++) {
+        if(other.values[i] != -1)
+            values[i] = (values[i] == -1 ? 0 : values[i]) + other.values[i];
+    }
+    return *this;
+}
+
+PerfCounters::Counts PerfCounters::Counts::operator-(const Counts& other) const {
+    Counts diff;
+    for (int i = 0; i < COUNTERS_NUM; i++) {
+        if(values[i] != -1 && other.values[i] != -1)
+            diff.values[i] = values[i] - other.values[i];
+    }
+    return diff;
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+bool PerfCounters::open() {
+    static const std::uint32_t types[COUNTERS_NUM] = {PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+    static const std::uint64_t configs[COUNTERS_NUM] = {PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+                                                        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int counter = 0; counter < COUNTERS_NUM; counter++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[counter];
+        attr.config = configs[counter];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // pid 0 and cpu -1: the calling thread, on any CPU
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+        if(fd == -1) {
+            if(group_fd == -1)
+                return false;
+            continue;
+        }
+        if(group_fd == -1)
+            group_fd = fd;
+        fds.push_back(fd);
+        opened.push_back(Counter(counter));
+    }
+    return true;
+}
+
+PerfCounters::Counts PerfCounters::read() const {
+    Counts counts;
+    if(group_fd == -1)
+        return counts;
+
+    // nr, time_enabled, time_running, then a value per opened counter
+    std::uint64_t data[3 + COUNTERS_NUM];
+    if(::read(group_fd, data, sizeof(data)) < (ssize_t)((3 + opened.size()) * sizeof(std::uint64_t)))
+        return counts;
+    double scale = data[2] ? double(data[1]) / data[2] : 1;
+    for (std::size_t i = 0; i < opened.size(); i++) {
+        counts.values[opened[i]] = std::int64_t(data[3 + i] * scale);
+    }
+    return counts;
+}
+
+const char* PerfCounters::getName(Counter counter) {
+    static const char* names[COUNTERS_NUM] = {"task_clock_ns", "instructions", "cycles", "cache_misses", "branch_misses"};
+    return names[counter];
+}
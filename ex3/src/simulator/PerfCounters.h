@@ -0,0 +1,60 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/**
+ * @file PerfCounters.h
+ * @brief This file contains the declaration of the PerfCounters class, per-thread hardware performance counters (perf_event_open).
+ */
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The PerfCounters class counts the CPU time, instructions, cycles, cache misses and branch misses of the thread that opened it (user space only).
+ * Counters the machine or the kernel doesn't provide (a VM without a PMU, perf_event_paranoid > 2) are just unavailable.
+ */
+class PerfCounters {
+public:
+    enum Counter { TASK_CLOCK_NS, INSTRUCTIONS, CYCLES, CACHE_MISSES, BRANCH_MISSES, COUNTERS_NUM };
+
+    /**
+     * @brief Counter values, -1 for an unavailable counter.
+     */
+    struct Counts {
+        std::array<std::int64_t, COUNTERS_NUM> values;
+
+        Counts() { values.fill(-1); }
+        Counts& operator+=(const Counts& other);
+        Counts operator-(const Counts& other) const;
+    };
+
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters();
+
+    /**
+     * @brief Opens the counters for the calling thread, they only count that thread.
+     * @return False if no counter could be opened.
+     */
+    bool open();
+
+    /**
+     * @brief Reads the counters so far (in a single system call), scaled up if the kernel had to multiplex them.
+     * @return The counts, all unavailable if the counters aren't open.
+     */
+    Counts read() const;
+
+    /**
+     * @brief Gets a counter's name, as used in the metrics.
+     */
+    static const char* getName(Counter counter);
+
+private:
+    int group_fd = -1; // the task clock, which every machine has, leads the group
+    std::vector<int> fds;
+    std::vector<Counter> opened; // in group order
+};
+
+#endif // PERF_COUNTERS_H
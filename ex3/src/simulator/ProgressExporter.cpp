@@ -0,0 +1,88 @@
+/**
+ * @file ProgressExporter.cpp
+ * @brief Implementation file for the ProgressExporter class.
+ */
+#include "ProgressExporter.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unistd.h>
+
+ProgressExporter::ProgressExporter(const BatchRunner& runner, std::filesystem::path path, std::chrono::seconds interval, std::size_t tasks_total,
+                                   std::size_t tasks_skipped)
+    : runner(runner), path(std::move(path)), interval(interval), tasks_total(tasks_total), tasks_skipped(tasks_skipped), start(std::chrono::steady_clock::now()) {
+    thread = std::jthread([this](std::stop_token stop) {
+        std::mutex sleep_mutex;
+        std::condition_variable_any sleep_cv;
+        std::unique_lock<std::mutex> sleep_lock(sleep_mutex);
+        do {
+            write();
+        } while(!sleep_cv.wait_for(sleep_lock, stop, this->interval, [&stop]() { return stop.stop_requested(); }));
+    });
+}
+
+ProgressExporter::~ProgressExporter() {
+    thread.request_stop();
+    thread.join();
+    write();
+}
+
+// a metric with its help and type lines
+static void writeMetric(std::ostream& out, const std::string& name, const std::string& type, const std::string& help, const std::string& value) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+    out << name << " " << value << "\n";
+}
+
+static void writeMetric(std::ostream& out, const std::string& name, const std::string& type, const std::string& help, std::size_t value) {
+    writeMetric(out, name, type, help, std::to_string(value));
+}
+
+static void writeMetric(std::ostream& out, const std::string& name, const std::string& type, const std::string& help, double value) {
+    writeMetric(out, name, type, help, std::isnan(value) ? std::string("NaN") : std::to_string(value));
+}
+
+void ProgressExporter::write() const {
+    BatchRunner::Progress progress = runner.getProgress();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // the runner may not have its tasks yet, the total is known from the start
+    std::size_t total = tasks_total;
+    std::size_t done = std::min(progress.tasks_done + tasks_skipped, total);
+    std::size_t remaining = total - done;
+    // the rate of the tasks that actually ran, the skipped ones took no time
+    double rate = elapsed > 0 ? progress.tasks_done / elapsed : 0;
+
+    // written next to the final file and renamed, so the collector never reads half a file
+    std::filesystem::path tmp_path = path;
+    tmp_path += "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        if(!out.is_open()) {
+            std::cerr << "Could not open " << tmp_path << " for writing the progress" << std::endl;
+            return;
+        }
+        writeMetric(out, "myrobot_tasks_total", "gauge", "Tasks in the batch.", total);
+        writeMetric(out, "myrobot_tasks_done", "gauge", "Tasks done, including those taken from the journal or the cache.", done);
+        writeMetric(out, "myrobot_tasks_remaining", "gauge", "Tasks not done yet.", remaining);
+        writeMetric(out, "myrobot_tasks_per_second", "gauge", "Tasks run per second since the batch started.", rate);
+        writeMetric(out, "myrobot_timeouts_total", "counter", "Tasks that timed out.", progress.timeouts);
+        writeMetric(out, "myrobot_errors_total", "counter", "Tasks whose algorithm failed.", progress.errors);
+        out << "# HELP myrobot_thread_busy_ratio The part of the elapsed time each worker spent running and writing tasks.\n";
+        out << "# TYPE myrobot_thread_busy_ratio gauge\n";
+        for (std::size_t i = 0; i < progress.busy.size(); i++) {
+            out << "myrobot_thread_busy_ratio{thread=\"" << i << "\"} " << std::to_string(elapsed > 0 ? progress.busy[i].count() / 1e6 / elapsed : 0) << "\n";
+        }
+        writeMetric(out, "myrobot_eta_seconds", "gauge", "The estimated time until the batch is done, NaN before the first task is done.",
+                    remaining == 0 ? 0 : (rate > 0 ? remaining / rate : std::nan("")));
+        // the batch is stalled if this stops moving
+        writeMetric(out, "myrobot_last_update_timestamp_seconds", "gauge", "When this file was written (Unix time).",
+                    std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if(ec)
+        std::cerr << "Could not write the progress to " << path << ": " << ec.message() << std::endl;
+}
@@ -0,0 +1,48 @@
+#ifndef PROGRESS_EXPORTER_H
+#define PROGRESS_EXPORTER_H
+
+/**
+ * @file ProgressExporter.h
+ * @brief This file contains the declaration of the ProgressExporter class, which lets myrobot report the progress of a long batch.
+ */
+
+#include "BatchRunner.h"
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+/**
+ * @brief The ProgressExporter class periodically writes the progress of a running batch as a Prometheus textfile
+ * (for the node exporter's textfile collector). It only reads the runner's per-worker counters, from its own thread.
+ */
+class ProgressExporter {
+public:
+    /**
+     * @brief Starts writing the file.
+     * @param runner The running batch.
+     * @param path The metrics file, it's replaced atomically (by a rename) on every update.
+     * @param interval The time between updates.
+     * @param tasks_total The tasks of the batch, including those done without the runner.
+     * @param tasks_skipped The tasks of the batch that were done without the runner (by the journal or the cache).
+     */
+    ProgressExporter(const BatchRunner& runner, std::filesystem::path path, std::chrono::seconds interval, std::size_t tasks_total, std::size_t tasks_skipped);
+
+    /**
+     * @brief Writes a last update and stops.
+     */
+    ~ProgressExporter();
+
+private:
+    const BatchRunner& runner;
+    std::filesystem::path path;
+    std::chrono::seconds interval;
+    std::size_t tasks_total;
+    std::size_t tasks_skipped;
+    std::chrono::steady_clock::time_point start;
+    std::jthread thread;
+
+    void write() const;
+};
+
+#endif // PROGRESS_EXPORTER_H
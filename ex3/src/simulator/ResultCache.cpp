@@ -0,0 +1,81 @@
+/**
+ * @file ResultCache.cpp
+ * @brief Implementation file for the ResultCache class.
+ */
+#include "ResultCache.h"
+#include "TaskJournal.h"
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+std::string ResultCache::open(const std::filesystem::path& dir) {
+    this->dir = dir;
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if(ec) {
+        return "Could not create the cache directory " + dir.string() + ": " + ec.message();
+    }
+    return "";
+}
+
+// two 64 bit FNV-1a hashes with different offsets, 128 bits are plenty to tell files apart
+std::string ResultCache::hashFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+        return "";
+
+    std::uint64_t h1 = 0xcbf29ce484222325ULL, h2 = 0x84222325cbf29ce4ULL;
+    const std::uint64_t prime = 0x100000001b3ULL;
+    char buffer[1 << 16];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        for (std::streamsize i = 0; i < file.gcount(); i++) {
+            h1 = (h1 ^ (unsigned char)buffer[i]) * prime;
+            h2 = (h2 ^ (unsigned char)buffer[i]) * prime;
+        }
+    }
+
+    std::ostringstream hex;
+    hex << std::hex << std::setfill('0') << std::setw(16) << h1 << std::setw(16) << h2;
+    return hex.str();
+}
+
+std::string ResultCache::makeKey(const std::string& house_hash, const std::string& plugin_hash) {
+    return house_hash + "-" + plugin_hash + "-v" + SIMULATOR_VERSION;
+}
+
+// an entry is the task's record line followed by its steps line
+bool ResultCache::find(const std::string& key, TaskResult& result) const {
+    std::ifstream file(dir / (key + ".result"));
+    std::string record, steps;
+    if(!file || !std::getline(file, record) || !std::getline(file, steps))
+        return false;
+
+    std::string house, algorithm;
+    if(!TaskJournal::parseRecord(record, house, algorithm, result))
+        return false;
+    result.steps = std::move(steps);
+    return true;
+}
+
+void ResultCache::store(const std::string& key, const TaskResult& result) const {
+    if(result.getOutcome() == "TIMEOUT" || result.getOutcome() == "ERROR")
+        return;
+
+    // written to a temporary file and renamed, so concurrent runs never read a partial entry
+    std::ostringstream tmp_name;
+    tmp_name << key << ".tmp" << getpid() << "_" << std::this_thread::get_id();
+    std::filesystem::path tmp_path = dir / tmp_name.str();
+    {
+        std::ofstream file(tmp_path);
+        if(!file)
+            return;
+        file << TaskJournal::formatRecord("", "", result) << "\n" << result.steps << "\n";
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, dir / (key + ".result"), ec);
+    if(ec)
+        std::filesystem::remove(tmp_path, ec);
+}
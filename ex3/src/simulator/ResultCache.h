@@ -0,0 +1,61 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+/**
+ * @file ResultCache.h
+ * @brief This file contains the declaration of the ResultCache class, a content addressed cache of task results.
+ */
+
+#include "BatchRunner.h"
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief The ResultCache class keeps task results in a directory, one file per result, named by a key made of
+ * the content hash of the house file, the content hash of the plugin and the simulator version.
+ * Any change to one of them gives a new key, so stale results are never found.
+ */
+class ResultCache {
+public:
+    /**
+     * @brief Opens (and creates if needed) the cache directory.
+     * @param dir The cache directory.
+     * @return An error message, empty on success.
+     */
+    std::string open(const std::filesystem::path& dir);
+
+    /**
+     * @brief Hashes a file's content.
+     * @param path The file.
+     * @return The hash as hex digits, empty if the file can't be read.
+     */
+    static std::string hashFile(const std::filesystem::path& path);
+
+    /**
+     * @brief Makes the key of a house&plugin pair.
+     * @param house_hash The house file's hash.
+     * @param plugin_hash The plugin's hash.
+     * @return The key.
+     */
+    static std::string makeKey(const std::string& house_hash, const std::string& plugin_hash);
+
+    /**
+     * @brief Looks for a cached result.
+     * @param key The pair's key.
+     * @param result Set to the cached result (with its steps string) if found.
+     * @return True if found.
+     */
+    bool find(const std::string& key, TaskResult& result) const;
+
+    /**
+     * @brief Stores a result, may be called from several threads. Timed out and failed tasks aren't stored.
+     * @param key The pair's key.
+     * @param result The result, with its steps string.
+     */
+    void store(const std::string& key, const TaskResult& result) const;
+
+private:
+    std::filesystem::path dir;
+};
+
+#endif // RESULT_CACHE_H
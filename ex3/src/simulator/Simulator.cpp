@@ -4,42 +4,104 @@
  */
 
 #include "Simulator.h"
+#include <charconv>
 #include <sstream>
 
+static std::string getMemoryLimitError(const MemoryAccount& account) {
+    return "Algorithm exceeded the memory limit of " + std::to_string(account.getLimit()) + " bytes";
+}
+
+// the log is appended to without temporary strings, so it only allocates from the simulator's memory resource
+template <typename Number>
+static void appendNumber(std::pmr::string& log, Number number) {
+    char digits[24];
+    log.append(digits, std::to_chars(digits, digits + sizeof(digits), number).ptr);
+}
+
+static void appendCoords(std::pmr::string& log, const Coords& coords) {
+    log += '(';
+    appendNumber(log, coords.x);
+    log += ", ";
+    appendNumber(log, coords.y);
+    log += ')';
+}
+
+static void appendStep(std::pmr::string& log, Step step) {
+    log += step == Step::North ? "North" :
+           step == Step::South ? "South" :
+           step == Step::East ? "East" :
+           step == Step::West ? "West" :
+           step == Step::Stay ? "Stay" : "Finish";
+}
+
+Simulator::Simulator(std::pmr::memory_resource* memory) : memory(memory), house(memory), rres(memory) {}
 
 std::string Simulator::run() {
     
     rres.steps_taken.reserve(maxSteps+1);
     auto timeout = std::chrono::milliseconds(maxSteps);
     auto start = std::chrono::high_resolution_clock::now();
+    PerfCounters::Counts run_start_counts = perf_counters ? perf_counters->read() : PerfCounters::Counts();
 
-    rres.log_info += "Docking Station Location: " + (std::ostringstream() << house.getDockingStationCoords()).str() + "\n";
+    if(record_log) {
+        rres.log_info += "Docking Station Location: ";
+        appendCoords(rres.log_info, house.getDockingStationCoords());
+        rres.log_info += '\n';
+    }
 
+    auto step_start = std::chrono::steady_clock::now();
     for (size_t i = 0; i < maxSteps+1 && !rres.finished; i++)
     {
+        // a step lasts until the next one starts, so the last step (which ends the run) isn't timed
+        if(profile_steps) {
+            auto now = std::chrono::steady_clock::now();
+            if(i > 0)
+                rres.step_latency.add(now - step_start);
+            step_start = now;
+        }
+
         // Append details to the log string before executing each step
-        rres.log_info += "******* Step " + std::to_string(i + 1) + " *******\n";
-        rres.log_info += "Current Location: " + (std::ostringstream() << location).str() + "\n";  // Using the overloaded << operator
-        rres.log_info += "Remaining Steps Number: " + std::to_string(maxSteps - i) + "\n";
-        rres.log_info += "Battery Left: " + std::to_string(battery_left) + "\n";
-        rres.log_info += "House Total Dirt: " + std::to_string(house.getTotalDirt()) + "\n";
+        if(record_log) {
+            rres.log_info += "******* Step ";
+            appendNumber(rres.log_info, i + 1);
+            rres.log_info += " *******\nCurrent Location: ";
+            appendCoords(rres.log_info, location);
+            rres.log_info += "\nRemaining Steps Number: ";
+            appendNumber(rres.log_info, maxSteps - i);
+            rres.log_info += "\nBattery Left: ";
+            battery.appendTo(rres.log_info);
+            rres.log_info += "\nHouse Total Dirt: ";
+            appendNumber(rres.log_info, house.getTotalDirt());
+            rres.log_info += '\n';
+        }
         
-        if(battery_left == 0 && location != house.getDockingStationCoords()) {
+        if(battery.isEmpty() && location != house.getDockingStationCoords()) {
             // Robot is DEAD
             break;
         }
 
         Step next_step;
         try {
-            next_step = algo->nextStep();
+            PerfCounters::Counts step_start_counts = perf_counters ? perf_counters->read() : PerfCounters::Counts();
+            {
+                MemoryAccount::Scope memory_scope(&algorithm_memory);
+                next_step = algo->nextStep();
+            }
+            if(perf_counters)
+                rres.algorithm_counts += perf_counters->read() - step_start_counts;
         }
         catch (const std::exception& e) {
+            if(algorithm_memory.isLimitExceeded())
+                return getMemoryLimitError(algorithm_memory);
             std::string what = e.what();
             return "Caught an exception from algorithm: " + what;
         }
         catch (...) {
             return "Unknown exception from algorithm";
         }
+        // also when the algorithm caught the std::bad_alloc itself
+        if(algorithm_memory.isLimitExceeded())
+            return getMemoryLimitError(algorithm_memory);
 
         // Timeout handling right after next_step()
         if((std::chrono::high_resolution_clock::now() - start) > timeout) {
@@ -50,7 +112,11 @@ std::string Simulator::run() {
         if(next_step == Step::Finish) {
             rres.finished = true;
             rres.steps_taken.push_back('F');
-            rres.log_info += "Chosen Step: " + (std::ostringstream() << next_step).str() + "\n";
+            if(record_log) {
+                rres.log_info += "Chosen Step: ";
+                appendStep(rres.log_info, next_step);
+                rres.log_info += '\n';
+            }
             break;
         }
         else if(i == maxSteps) {
@@ -101,85 +167,98 @@ std::string Simulator::run() {
             break;
         }
 
-        rres.log_info += "Chosen Step: " + (std::ostringstream() << next_step).str() + "\n";
-        rres.log_info += "\n"; // line break
+        if(record_log) {
+            rres.log_info += "Chosen Step: ";
+            appendStep(rres.log_info, next_step);
+            rres.log_info += "\n\n"; // and a line break
+        }
     }
 
+    if(perf_counters) {
+        PerfCounters::Counts run_counts = perf_counters->read() - run_start_counts;
+        rres.simulator_counts = run_counts - rres.algorithm_counts;
+    }
     return "";
 }
 
-size_t Simulator::calcScoreAndWriteResults(bool write_output_file) {
-    size_t dirt_left = house.getTotalDirt();
-    size_t num_steps = rres.steps_taken.size();
-    Coords docking_station = house.getDockingStationCoords();
-    bool in_dock = location == docking_station;
-    size_t score;
-    // calculating score
-    if(rres.timeout_reached) {  // default score
-        score = maxSteps * 2 + initial_dirt * 300 + 2000;
-    }
-    else if(!rres.finished && battery_left <= 0 && !in_dock) { // DEAD
-        score = maxSteps + dirt_left * 300 + 2000;
-    }
-    else if(rres.finished && !in_dock) { // FINISHED
-        score = maxSteps + dirt_left * 300 + 3000;
-    }
-    else {  // WORKING
-        score = num_steps + dirt_left * 300 + (in_dock ? 0 : 1000);
-    }
-
-    std::ofstream output_file(house_file_path.filename().replace_extension("").string() + "-" + algo_name + ".txt"); // Open output file
+size_t Simulator::calcScore() {
+    return calcScore(maxSteps, initial_dirt, getDirtLeft(), rres.steps_taken.size(), rres.finished, battery.isDepleted(), isInDock(), rres.timeout_reached);
+}
 
-    if (!output_file) {
-        std::cerr << "Failed to open the output file" << std::endl;
-        return 0;
+// num_steps counts the Finish step as well (the output file's NumSteps doesn't)
+size_t Simulator::calcScore(size_t max_steps, size_t initial_dirt, size_t dirt_left, size_t num_steps, bool finished, bool battery_empty, bool in_dock, bool timeout_reached) {
+    if(timeout_reached) {  // default score
+        return max_steps * 2 + initial_dirt * 300 + 2000;
     }
-
-    // writing output file
-    if(write_output_file) {
-        output_file << "NumSteps = " << num_steps - rres.finished << std::endl;
-        output_file << "DirtLeft = " << dirt_left << std::endl;
-        output_file << "Status = " << (rres.finished ? "FINISHED" : (battery_left > 0 ? "WORKING" : "DEAD")) << std::endl;
-        output_file << "InDock = " << (in_dock ? "TRUE" : "FALSE") << std::endl;
-        output_file << "Score = " << score << std::endl;
-        output_file << "Steps:" << std::endl;
-        for (size_t i = 0; i < rres.steps_taken.size(); i++)
-        {
-            output_file << rres.steps_taken[i];
-        }
-        output_file << std::endl;
-
-        output_file.close();
+    else if(!finished && battery_empty && !in_dock) { // DEAD
+        return max_steps + dirt_left * 300 + 2000;
     }
-
-    // writing log file
-    std::ofstream log_file(house_file_path.filename().replace_extension("").string() + "-" + algo_name + ".log"); // Open log file
-
-    if (!log_file) {
-        std::cerr << "Failed to open the output file" << std::endl;
-        return 0;
+    else if(finished && !in_dock) { // FINISHED
+        return max_steps + dirt_left * 300 + 3000;
     }
-    log_file << rres.log_info;
-    log_file.close();
+    // WORKING
+    return num_steps + dirt_left * 300 + (in_dock ? 0 : 1000);
+}
 
-    return score;
+std::string Simulator::calcStatus(bool finished, bool battery_empty) {
+    return finished ? "FINISHED" : (battery_empty ? "DEAD" : "WORKING");
 }
 
 // this function creates a common HouseValues object by reading a house file, it saves us from reading every time we want to use that house in the simulation
 Simulator::HouseValues Simulator::readHouseFile(std::filesystem::path house_file_path)
 {
-    HouseValues hv;
-
     //  open input file
     std::ifstream file(house_file_path);
     if(!file)
     {
+        HouseValues hv;
         hv.error_message = "Input file \"" +  house_file_path.string() + "\" does not exist";
-        file.close();
         return hv;
     }
 
-    hv.house_path = house_file_path;
+    return readHouse(file, house_file_path);
+}
+
+std::uint64_t Simulator::fingerprintHouse(const HouseValues& hv) {
+    // FNV-1a over the values, in a fixed order
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    auto add = [&hash](std::uint64_t value) {
+        for (int byte = 0; byte < 8; byte++) {
+            hash = (hash ^ ((value >> (byte * 8)) & 0xff)) * 0x100000001b3ULL;
+        }
+    };
+    add(hv.maxSteps);
+    add(hv.battery_capacity);
+    add(hv.docking_station.x);
+    add(hv.docking_station.y);
+    add(hv.tiles.getDimX());
+    add(hv.tiles.getDimY());
+    for (size_t x = 0; x < hv.tiles.getDimX(); x++) {
+        for (size_t y = 0; y < hv.tiles.getDimY(); y++) {
+            add(hv.tiles(x, y).getStatus());
+        }
+    }
+    return hash;
+}
+
+bool Simulator::isSameHouse(const HouseValues& a, const HouseValues& b) {
+    if(a.maxSteps != b.maxSteps || a.battery_capacity != b.battery_capacity || !(a.docking_station == b.docking_station) ||
+       a.tiles.getDimX() != b.tiles.getDimX() || a.tiles.getDimY() != b.tiles.getDimY())
+        return false;
+    for (size_t x = 0; x < a.tiles.getDimX(); x++) {
+        for (size_t y = 0; y < a.tiles.getDimY(); y++) {
+            if(a.tiles(x, y).getStatus() != b.tiles(x, y).getStatus())
+                return false;
+        }
+    }
+    return true;
+}
+
+// same as readHouseFile, for house data that is already in memory (house_path only names the house)
+Simulator::HouseValues Simulator::readHouse(std::istream& file, std::filesystem::path house_path)
+{
+    HouseValues hv;
+    hv.house_path = house_path;
 
     std::string line;
     size_t rows_num, cols_num;
@@ -196,7 +275,6 @@ Simulator::HouseValues Simulator::readHouseFile(std::filesystem::path house_file
     {
         if(!std::getline(file, line)) {
             hv.error_message = "Error: input file should have at least 5 lines";
-            file.close();
             return hv;
         }
 
@@ -221,7 +299,6 @@ Simulator::HouseValues Simulator::readHouseFile(std::filesystem::path house_file
 
         if(line_error != "") {
             hv.error_message = "Error: " + line_error + "; in this line(" + std::to_string(line_number) + "): \"" + line + "\"";
-            file.close();
             return hv;
         }
     }
@@ -241,7 +318,6 @@ Simulator::HouseValues Simulator::readHouseFile(std::filesystem::path house_file
                 if(tile_status == DOCKING_STATION) {
                     if (docking_station_found) {
                         hv.error_message = "Error: There can be only one docking station";
-                        file.close();
                         return hv;
                     }
                     hv.docking_station = Coords(i,j);
@@ -256,31 +332,48 @@ Simulator::HouseValues Simulator::readHouseFile(std::filesystem::path house_file
     catch(const std::runtime_error& e) {
         std::string what = e.what();
         hv.error_message = "Error in input file reading: " + what;
-        file.close();
         return hv;
     }
     if(!docking_station_found) {
         hv.error_message = "Error: No docking station found in the input file";
-        file.close();
         return hv;
     }
-    file.close();
-
     return hv;
 }
 
-void Simulator::setHouseValues(Simulator::HouseValues hv) { // copy constructor is called on purpose
-    house.setTiles(std::move(hv.tiles));
+// the tiles are copied, the house values are shared by all the tasks of the house
+void Simulator::setHouseValues(const Simulator::HouseValues& hv) {
+    house.setTiles(hv.tiles);
     house.setDockingStation(hv.docking_station);
     house.setTotalDirt(hv.total_dirt);
     house_file_path = hv.house_path;
     maxSteps = hv.maxSteps;
     battery_capacity = hv.battery_capacity;
-    battery_left = battery_capacity;
+    battery = Battery(battery_capacity);
     location = house.getDockingStationCoords();
     initial_dirt = house.getTotalDirt();
 }
 
+void Simulator::reset() {
+    algo.reset();
+    algorithm_memory.reset();
+    perf_counters = nullptr;
+
+    // a string moved from a short one keeps its buffer, so the log's is swapped out to be freed before the memory is released
+    std::pmr::string(memory).swap(rres.log_info);
+    rres = RunResults(memory);
+    house = House(memory);
+}
+
+void Simulator::setMaxSteps(size_t max_steps) {
+    maxSteps = max_steps;
+}
+
+void Simulator::setBatteryCapacity(size_t battery_capacity) {
+    this->battery_capacity = battery_capacity;
+    battery = Battery(battery_capacity);
+}
+
 void Simulator::setAlgorithm(std::unique_ptr<AbstractAlgorithm> algo) {
     this->algo = std::move(algo);
 	this->algo->setMaxSteps(maxSteps);
@@ -289,40 +382,119 @@ void Simulator::setAlgorithm(std::unique_ptr<AbstractAlgorithm> algo) {
 	this->algo->setBatteryMeter(batteryMeter);
 }
 
+bool Simulator::reuseAlgorithm(std::unique_ptr<AbstractAlgorithm> algo) {
+    // reset runs outside the account, which counts only what the algorithm allocates from here on
+    try {
+        getResettable(*algo)->reset();
+    }
+    catch (...) {
+        return false;
+    }
+    setAlgorithm(std::move(algo));
+    return true;
+}
+
+std::unique_ptr<AbstractAlgorithm> Simulator::releaseAlgorithm() {
+    return std::move(algo);
+}
+
+ResettableAlgorithm* Simulator::getResettable(AbstractAlgorithm& algo) {
+    ResettableAlgorithm* resettable = dynamic_cast<ResettableAlgorithm*>(&algo);
+    if(!resettable || resettable->getResettableVersion() != ResettableAlgorithm::VERSION)
+        return nullptr;
+    return resettable;
+}
+
 void Simulator::setAlgorithmName(std::string algo_name) {
     this->algo_name = algo_name;
 }
 
+bool Simulator::setAlgorithmSeed(std::uint64_t seed) {
+    SeedableAlgorithm* seedable = dynamic_cast<SeedableAlgorithm*>(algo.get());
+    if(!seedable)
+        return false;
+    seedable->setSeed(seed);
+    return true;
+}
+
+bool Simulator::isDeterministic(const AbstractAlgorithm& algo) {
+    const SeedableAlgorithm* seedable = dynamic_cast<const SeedableAlgorithm*>(&algo);
+    return !seedable || seedable->isDeterministic();
+}
+
+void Simulator::setPerfCounters(const PerfCounters* perf_counters) {
+    this->perf_counters = perf_counters;
+}
+
+void Simulator::setProfileSensors(bool profile_sensors) {
+    this->profile_sensors = profile_sensors;
+}
+
+void Simulator::setProfileSteps(bool profile_steps) {
+    this->profile_steps = profile_steps;
+}
+
+void Simulator::setMemoryLimit(std::size_t limit_bytes) {
+    algorithm_memory.setLimit(limit_bytes);
+}
+
+size_t Simulator::getAlgorithmPeakBytes() const {
+    return algorithm_memory.getPeakBytes();
+}
+
+
+void Simulator::setRecordLog(bool record_log) {
+    this->record_log = record_log;
+}
+
 Simulator::SimulatorSensor::SimulatorSensor(Simulator& parent) : parent(parent) {}
 
 bool Simulator::HouseWallsSensor::isWall(Direction d) const {
-    return parent.house.isWall(parent.location + d);
+    return parent.profileSensor(WALLS_SENSOR, [this, d]() { return parent.house.isWall(parent.location + d); });
 }
 
 std::size_t Simulator::HouseBatteryMeter::getBatteryState() const {
-    return parent.battery_left;
+    return parent.profileSensor(BATTERY_METER, [this]() { return parent.battery.getState(); });
 }
 
 int Simulator::HouseDirtSensor::dirtLevel() const {
-    return parent.house.getDirtLevel(parent.location);
+    return parent.profileSensor(DIRT_SENSOR, [this]() { return static_cast<int>(parent.house.getDirtLevel(parent.location)); });
+}
+
+const char* Simulator::getSensorName(Sensor sensor) {
+    static const char* names[SENSORS_NUM] = {"walls", "dirt", "battery"};
+    return names[sensor];
 }
 
 void Simulator::charge() {
-    battery_left = std::min((float)battery_capacity, battery_left + ((float)battery_capacity)/20);
+    battery.charge();
 }
 
-float Simulator::decreaseBattery() {
-    if(battery_left == 0) {
-        // We shouldn't reach here
-        throw std::runtime_error("Battery is dead and cannot perform the requested move!");
-    }
-    return battery_left--;
+void Simulator::decreaseBattery() {
+    battery.discharge();
 }
 
 size_t Simulator::getMaxSteps() {
     return maxSteps;
 }
 
+// number of steps as reported in the output file (the Finish step is not counted)
+size_t Simulator::getNumSteps() {
+    return rres.steps_taken.size() - rres.finished;
+}
+
+size_t Simulator::getDirtLeft() {
+    return house.getTotalDirt();
+}
+
+bool Simulator::isInDock() {
+    return location == house.getDockingStationCoords();
+}
+
+std::string Simulator::getStatus() {
+    return calcStatus(rres.finished, battery.isDepleted());
+}
+
 size_t Simulator::getInitialDirt() {
     return initial_dirt;
 }
@@ -2,23 +2,52 @@
 #define SIMULATOR_H
 
 #include "House.h"
+#include "PerfCounters.h"
+#include "MemoryAccount.h"
+#include "LatencyHistogram.h"
+#include "Battery.h"
 #include "../common/BatteryMeter.h"
 #include "../common/DirtSensor.h"
 #include "../common/WallSensor.h"
 #include "../common/AbstractAlgorithm.h"
+#include "../common_algo_sim/SeedableAlgorithm.h"
+#include "../common_algo_sim/ResettableAlgorithm.h"
 #include <stdexcept>
 #include <fstream>
 #include <string>
 #include <filesystem>
 #include <memory>
+#include <memory_resource>
 #include <regex>
+#include <array>
 #include <chrono>
 
+/**
+ * @brief The version of the simulation rules (moves, battery, scoring), it must change whenever a house&algorithm pair could get a different result.
+ */
+constexpr const char* SIMULATOR_VERSION = "2";
+
 /**
  * @brief The Simulator class represents a vacuum cleaner simulator.
  */
 class Simulator {
-    
+public:
+    enum Sensor { WALLS_SENSOR, DIRT_SENSOR, BATTERY_METER, SENSORS_NUM };
+
+    /**
+     * @brief The calls an algorithm made to one of its sensors, with setProfileSensors.
+     */
+    struct SensorStats {
+        std::size_t calls = 0;
+        std::chrono::nanoseconds time{0}; /**< Including the clock reads around every call. */
+    };
+
+    /**
+     * @brief Gets a sensor's name in reports (walls, dirt or battery).
+     */
+    static const char* getSensorName(Sensor sensor);
+
+private:
     class SimulatorSensor {
     protected:
         Simulator& parent;
@@ -45,6 +74,7 @@ class Simulator {
     };
 
 
+    std::pmr::memory_resource* memory; /**< The house tiles, the steps and the log are allocated from it. */
     House house; /**< The house object representing the house to be cleaned in the simulation. */
     HouseWallsSensor wallsSensor = HouseWallsSensor(*this);
     HouseBatteryMeter batteryMeter = HouseBatteryMeter(*this);
@@ -52,26 +82,57 @@ class Simulator {
     std::size_t maxSteps;
     Coords location; /**< The current location of the robot. */
     std::size_t battery_capacity; /**< The battery capacity of the robot. */
-    float battery_left; /**< The remaining battery level of the robot. */
+    Battery battery; /**< The remaining battery level of the robot. */
     size_t initial_dirt;
     std::unique_ptr<AbstractAlgorithm> algo;
     std::string algo_name;
     std::filesystem::path house_file_path;
+    bool record_log = true;
+    const PerfCounters* perf_counters = nullptr;
+    MemoryAccount algorithm_memory; // what nextStep allocates
+    bool profile_sensors = false;
+    bool profile_steps = false;
 
-    float decreaseBattery();
+    // runs a sensor's query, counting it with setProfileSensors
+    template <typename Query>
+    auto profileSensor(Sensor sensor, Query query) {
+        if(!profile_sensors)
+            return query();
+        auto start = std::chrono::steady_clock::now();
+        auto value = query();
+        SensorStats& stats = rres.sensor_stats[sensor];
+        stats.calls++;
+        stats.time += std::chrono::steady_clock::now() - start;
+        return value;
+    }
+
+    void decreaseBattery();
     
     void charge();
 
 public:
     struct RunResults {
-        std::string log_info = "";
-        std::vector<char> steps_taken;
+        std::pmr::string log_info;
+        std::pmr::vector<char> steps_taken;
         bool finished = false;
         bool timeout_reached = false;
+        PerfCounters::Counts algorithm_counts; /**< Counted in nextStep (and the sensors it calls), with setPerfCounters. */
+        PerfCounters::Counts simulator_counts; /**< The rest of run, with setPerfCounters. */
+        std::array<SensorStats, SENSORS_NUM> sensor_stats; /**< With setProfileSensors. */
+        LatencyHistogram step_latency; /**< With setProfileSteps. */
+
+        explicit RunResults(std::pmr::memory_resource* memory = std::pmr::get_default_resource()) : log_info(memory), steps_taken(memory) {}
     };
 
     RunResults rres;
 
+    /**
+     * @brief Constructs a simulator that allocates its buffers (the house tiles, the steps and the log) from the given memory resource,
+     * which must outlive it. A std::pmr::monotonic_buffer_resource (see TaskArena) may be released after reset.
+     * @param memory The memory resource.
+     */
+    explicit Simulator(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
 
     struct HouseValues {
         std::string error_message = "";
@@ -85,18 +146,122 @@ public:
 
     std::string run();
 
-    size_t calcScoreAndWriteResults(bool write_output_file);
+    size_t calcScore();
+
+    static size_t calcScore(size_t max_steps, size_t initial_dirt, size_t dirt_left, size_t num_steps, bool finished, bool battery_empty, bool in_dock, bool timeout_reached);
+
+    static std::string calcStatus(bool finished, bool battery_empty);
 
     static HouseValues readHouseFile(std::filesystem::path file_path);
 
-    void setHouseValues(Simulator::HouseValues hv);
+    static HouseValues readHouse(std::istream& input, std::filesystem::path house_path);
+
+    /**
+     * @brief Gets a fingerprint of everything a simulation depends on in a house: its tiles, docking station, MaxSteps and MaxBattery (not its path).
+     * Houses with equal fingerprints are very likely identical, isSameHouse tells for sure.
+     */
+    static std::uint64_t fingerprintHouse(const HouseValues& hv);
+
+    /**
+     * @brief Tells whether every simulation of the two houses gives the same results (same tiles, docking station, MaxSteps and MaxBattery).
+     */
+    static bool isSameHouse(const HouseValues& a, const HouseValues& b);
+
+    void setHouseValues(const Simulator::HouseValues& hv);
+
+    /**
+     * @brief Makes the simulator ready for another task (setHouseValues and so on): drops the algorithm, the house and the results of the last run,
+     * so nothing is left in the memory resource and it may be released.
+     */
+    void reset();
+
+    /**
+     * @brief Overrides the house's MaxSteps. Must be called after setHouseValues and before setAlgorithm.
+     */
+    void setMaxSteps(size_t max_steps);
+
+    /**
+     * @brief Overrides the house's MaxBattery, the battery starts full. Must be called after setHouseValues and before setAlgorithm.
+     */
+    void setBatteryCapacity(size_t battery_capacity);
 
     void setAlgorithm(std::unique_ptr<AbstractAlgorithm> algo);
 
+    /**
+     * @brief Resets an algorithm that already ran a task and sets it, instead of a new instance (see ResettableAlgorithm).
+     * What the algorithm kept from its last run isn't counted as its memory, only what it allocates after reset is,
+     * so getAlgorithmPeakBytes excludes the capacity it kept (and is lower than a new instance's by up to that much).
+     * Must be called where setAlgorithm is, after setMemoryLimit.
+     * @param algo The algorithm, getResettable must give it.
+     * @return false if reset threw (the algorithm is dropped then, and a new instance should be set).
+     */
+    bool reuseAlgorithm(std::unique_ptr<AbstractAlgorithm> algo);
+
+    /**
+     * @brief Takes the algorithm back after run, to reuse it for another task.
+     */
+    std::unique_ptr<AbstractAlgorithm> releaseAlgorithm();
+
+    /**
+     * @brief Gets the algorithm's ResettableAlgorithm interface, if it implements the version the simulator knows.
+     * @return The interface, nullptr if the algorithm can't be reset.
+     */
+    static ResettableAlgorithm* getResettable(AbstractAlgorithm& algo);
+
     void setAlgorithmName(std::string algo_name);
 
+    /**
+     * @brief Seeds the algorithm's randomness, if it implements SeedableAlgorithm. Must be called after setAlgorithm.
+     * @param seed The seed.
+     * @return false if the algorithm can't be seeded.
+     */
+    bool setAlgorithmSeed(std::uint64_t seed);
+
+    /**
+     * @brief Tells whether an algorithm is deterministic, algorithms that don't implement SeedableAlgorithm are assumed to be.
+     */
+    static bool isDeterministic(const AbstractAlgorithm& algo);
+
+    void setRecordLog(bool record_log);
+
+    /**
+     * @brief Counts the run with the given counters, which must be open on the thread that calls run.
+     * @param perf_counters The counters, or nullptr not to count.
+     */
+    void setPerfCounters(const PerfCounters* perf_counters);
+
+    /**
+     * @brief Counts the algorithm's calls to every sensor, and the time they take, into rres.sensor_stats.
+     */
+    void setProfileSensors(bool profile_sensors);
+
+    /**
+     * @brief Times every step (the algorithm's nextStep and the simulator's move) into rres.step_latency.
+     */
+    void setProfileSteps(bool profile_steps);
+
+    /**
+     * @brief Limits the heap memory the algorithm may hold (what its nextStep calls allocated and didn't free).
+     * An allocation over the limit throws std::bad_alloc in the algorithm, and run returns an error.
+     * @param limit_bytes The limit, 0 for none.
+     */
+    void setMemoryLimit(std::size_t limit_bytes);
+
+    /**
+     * @brief Gets the peak heap memory held by the algorithm, counted in nextStep, may be called from another thread while run is running.
+     */
+    size_t getAlgorithmPeakBytes() const;
+
     size_t getMaxSteps();
 
+    size_t getNumSteps();
+
+    size_t getDirtLeft();
+
+    bool isInDock();
+
+    std::string getStatus();
+
     size_t getInitialDirt();
 
     std::filesystem::path getHousePath();
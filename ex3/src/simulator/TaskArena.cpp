@@ -0,0 +1,43 @@
+/**
+ * @file TaskArena.cpp
+ * @brief Implementation file for the TaskArena class.
+ */
+#include "TaskArena.h"
+#include <algorithm>
+
+void* TaskArena::HeapResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    taken += bytes;
+    return p;
+}
+
+void TaskArena::HeapResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool TaskArena::HeapResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+TaskArena::TaskArena(std::size_t initial_bytes)
+    : buffer(std::make_unique_for_overwrite<std::byte[]>(initial_bytes)), buffer_size(initial_bytes) {
+    arena.emplace(buffer.get(), buffer_size, &heap);
+}
+
+std::pmr::memory_resource* TaskArena::getResource() {
+    return &*arena;
+}
+
+void TaskArena::release() {
+    arena->release();
+    if(heap.taken == 0 || buffer_size >= HIGH_WATER) {
+        heap.taken = 0;
+        return;
+    }
+    // the task overflowed the buffer, the next one gets a buffer as large as all that the task took
+    buffer_size = std::min(buffer_size + heap.taken, HIGH_WATER);
+    heap.taken = 0;
+    arena.reset();
+    buffer = std::make_unique_for_overwrite<std::byte[]>(buffer_size);
+    arena.emplace(buffer.get(), buffer_size, &heap);
+}
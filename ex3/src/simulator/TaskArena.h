@@ -0,0 +1,58 @@
+#ifndef TASK_ARENA_H
+#define TASK_ARENA_H
+
+/**
+ * @file TaskArena.h
+ * @brief This file contains the declaration of the TaskArena class, a monotonic arena for the allocations of one task at a time.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @brief The TaskArena class gives a worker thread a std::pmr::monotonic_buffer_resource for the simulator of its current task,
+ * so the task's allocations are pointer bumps that never touch the global allocator (or contend with the other threads),
+ * and are all freed in one go by release when the task is done.
+ * The arena keeps a buffer that grows to what a task needed, up to HIGH_WATER, so the next tasks take nothing from the heap;
+ * a task that needs more than that takes the rest from the heap, and gives it back on release.
+ * Only the thread that owns the arena may allocate from it.
+ */
+class TaskArena {
+public:
+    static constexpr std::size_t HIGH_WATER = 16 << 20;
+
+    /**
+     * @brief Constructs the arena with a buffer of the given size.
+     */
+    explicit TaskArena(std::size_t initial_bytes = 64 << 10);
+    TaskArena(const TaskArena&) = delete;
+    TaskArena& operator=(const TaskArena&) = delete;
+
+    std::pmr::memory_resource* getResource();
+
+    /**
+     * @brief Frees everything allocated from the arena, nothing may use that memory anymore.
+     * The buffer grows to what was used if that didn't fit in it.
+     */
+    void release();
+
+private:
+    // the heap, for what doesn't fit in the buffer, counting how much of it the task took
+    class HeapResource : public std::pmr::memory_resource {
+    public:
+        std::size_t taken = 0;
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    HeapResource heap;
+    std::unique_ptr<std::byte[]> buffer;
+    std::size_t buffer_size;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+};
+
+#endif // TASK_ARENA_H
@@ -0,0 +1,127 @@
+/**
+ * @file TaskJournal.cpp
+ * @brief Implementation file for the TaskJournal class.
+ */
+#include "TaskJournal.h"
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+// house and algorithm names (file names, manifest labels) may hold the record's separators, which are written as %XX
+static std::string escapeName(const std::string& name) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string escaped;
+    for (unsigned char c : name) {
+        if(c == '%' || c == ',' || c == '\n' || c == '\r') {
+            escaped += '%';
+            escaped += hex[c >> 4];
+            escaped += hex[c & 0xF];
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// returns false if a % isn't followed by two hex digits
+static bool unescapeName(const std::string& escaped, std::string& name) {
+    name.clear();
+    for (std::size_t i = 0; i < escaped.size(); i++) {
+        if(escaped[i] != '%') {
+            name += escaped[i];
+            continue;
+        }
+        if(i + 2 >= escaped.size() || !std::isxdigit(static_cast<unsigned char>(escaped[i + 1])) || !std::isxdigit(static_cast<unsigned char>(escaped[i + 2])))
+            return false;
+        name += static_cast<char>(std::stoi(escaped.substr(i + 1, 2), nullptr, 16));
+        i += 2;
+    }
+    return true;
+}
+
+std::string TaskJournal::open(const std::filesystem::path& path, bool resume) {
+    this->path = path;
+
+    if(resume)
+        load(path);
+
+    file.open(path, resume ? std::ios::app : std::ios::trunc);
+    if(!file.is_open()) {
+        return "Could not open " + path.string() + " for writing the journal";
+    }
+    return "";
+}
+
+bool TaskJournal::load(const std::filesystem::path& path) {
+    std::ifstream existing(path);
+    if(!existing.is_open())
+        return false;
+    std::string line;
+    // a line without its newline was cut by the kill, it's ignored
+    while (existing.peek() != EOF && std::getline(existing, line) && !existing.eof()) {
+        std::string house, algorithm;
+        TaskResult result;
+        if(parseRecord(line, house, algorithm, result))
+            records[{house, algorithm}] = result;
+    }
+    return true;
+}
+
+bool TaskJournal::find(const std::string& house, const std::string& algorithm, TaskResult& result) const {
+    auto it = records.find({house, algorithm});
+    if(it == records.end())
+        return false;
+    result = it->second;
+    return true;
+}
+
+void TaskJournal::append(const std::string& house, const std::string& algorithm, const TaskResult& result) {
+    std::string line = formatRecord(house, algorithm, result) + "\n";
+
+    std::lock_guard<std::mutex> lock(file_mutex);
+    file << line << std::flush;
+}
+
+std::string TaskJournal::formatRecord(const std::string& house, const std::string& algorithm, const TaskResult& result) {
+    std::ostringstream line;
+    line << escapeName(house) << "," << escapeName(algorithm) << "," << result.score << "," << result.num_steps << "," << result.dirt_left << ","
+         << (result.in_dock ? "TRUE" : "FALSE") << "," << result.status << "," << result.getOutcome();
+    return line.str();
+}
+
+bool TaskJournal::parseRecord(const std::string& line, std::string& house, std::string& algorithm, TaskResult& result) {
+    std::vector<std::string> fields;
+    std::stringstream line_stream(line);
+    std::string field;
+    while (std::getline(line_stream, field, ','))
+        fields.push_back(field);
+    if(fields.size() != 8)
+        return false;
+
+    try {
+        result.score = std::stoi(fields[2]);
+        result.num_steps = std::stoull(fields[3]);
+        result.dirt_left = std::stoull(fields[4]);
+    } catch (std::exception& e) {
+        return false;
+    }
+    if(!unescapeName(fields[0], house) || !unescapeName(fields[1], algorithm))
+        return false;
+    result.in_dock = fields[5] == "TRUE";
+    result.status = fields[6];
+    result.timeout_reached = fields[7] == "TIMEOUT";
+    if(fields[7] == "ERROR")
+        result.error_message = "failed in a previous run";
+    return true;
+}
+
+void TaskJournal::remove() {
+    file.close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+std::size_t TaskJournal::size() const {
+    return records.size();
+}
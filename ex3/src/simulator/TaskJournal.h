@@ -0,0 +1,93 @@
+#ifndef TASK_JOURNAL_H
+#define TASK_JOURNAL_H
+
+/**
+ * @file TaskJournal.h
+ * @brief This file contains the declaration of the TaskJournal class, which lets myrobot resume a batch that was killed.
+ */
+
+#include "BatchRunner.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/**
+ * @brief The TaskJournal class appends a record for every task as soon as it's done,
+ * so a batch that was killed can be resumed without running those tasks again.
+ * Each record is a line: house,algorithm,score,num_steps,dirt_left,in_dock,status,outcome
+ */
+class TaskJournal {
+public:
+    /**
+     * @brief Opens the journal.
+     * @param path The journal file.
+     * @param resume Whether to load the records already in the file (otherwise the file is truncated).
+     * @return An error message, empty on success.
+     */
+    std::string open(const std::filesystem::path& path, bool resume);
+
+    /**
+     * @brief Loads the records of another journal file, like the journals of the shards of a batch.
+     * @param path The journal file.
+     * @return False if the file couldn't be read.
+     */
+    bool load(const std::filesystem::path& path);
+
+    /**
+     * @brief Looks for a task that is already done.
+     * @param house The house name.
+     * @param algorithm The algorithm name.
+     * @param result Set to the recorded result if found (without steps, log or timing).
+     * @return True if the task was found.
+     */
+    bool find(const std::string& house, const std::string& algorithm, TaskResult& result) const;
+
+    /**
+     * @brief Appends a record and flushes it, may be called from several threads.
+     * @param house The house name.
+     * @param algorithm The algorithm name.
+     * @param result The task's result.
+     */
+    void append(const std::string& house, const std::string& algorithm, const TaskResult& result);
+
+    /**
+     * @brief Closes and deletes the journal, once the batch is complete.
+     */
+    void remove();
+
+    /**
+     * @brief Formats a task's record (without a newline). A ',', '%' or newline in the house and algorithm names is written as %XX.
+     * @param house The house name.
+     * @param algorithm The algorithm name.
+     * @param result The task's result.
+     * @return The record.
+     */
+    static std::string formatRecord(const std::string& house, const std::string& algorithm, const TaskResult& result);
+
+    /**
+     * @brief Parses a record written by formatRecord.
+     * @param line The record.
+     * @param house Set to the house name.
+     * @param algorithm Set to the algorithm name.
+     * @param result Set to the recorded result (without steps, log or timing).
+     * @return False if the record is malformed.
+     */
+    static bool parseRecord(const std::string& line, std::string& house, std::string& algorithm, TaskResult& result);
+
+    /**
+     * @brief Gets the number of records loaded when resuming.
+     * @return The number of loaded records.
+     */
+    std::size_t size() const;
+
+private:
+    std::filesystem::path path;
+    std::ofstream file;
+    std::mutex file_mutex;
+    std::map<std::pair<std::string, std::string>, TaskResult> records;
+};
+
+#endif // TASK_JOURNAL_H
@@ -0,0 +1,92 @@
+/**
+ * @file TraceRecorder.cpp
+ * @brief Implementation file for the TraceRecorder class.
+ */
+#include "TraceRecorder.h"
+#include <fstream>
+#include <unistd.h>
+
+// the thread's id in the trace of the recorder that numbered it
+struct ThreadTraceId {
+    const TraceRecorder* recorder = nullptr;
+    int id = -1;
+};
+static thread_local ThreadTraceId thread_trace_id;
+
+static std::string jsonString(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c : s) {
+        if(c == '"' || c == '\\')
+            quoted += '\\';
+        if((unsigned char)c < 0x20)
+            continue;
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+TraceRecorder::Span::Span(TraceRecorder* recorder, std::string name, std::string category)
+    : recorder(recorder), name(std::move(name)), category(std::move(category)), start(Clock::now()) {}
+
+TraceRecorder::Span::~Span() {
+    if(recorder)
+        recorder->addSpan(recorder->getThreadId(), name, category, start, Clock::now());
+}
+
+TraceRecorder::TraceRecorder() : start(Clock::now()) {}
+
+long long TraceRecorder::toMicros(Clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - start).count();
+}
+
+int TraceRecorder::getThreadId() {
+    if(thread_trace_id.recorder != this) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        thread_trace_id = {this, next_thread_id++};
+    }
+    return thread_trace_id.id;
+}
+
+void TraceRecorder::setThreadName(const std::string& name) {
+    int thread_id = getThreadId();
+    std::lock_guard<std::mutex> lock(events_mutex);
+    events.push_back({'M', thread_id, name, "", 0, 0});
+}
+
+void TraceRecorder::addSpan(int thread_id, const std::string& name, const std::string& category, Clock::time_point start, Clock::time_point end) {
+    Event event{'X', thread_id, name, category, toMicros(start), toMicros(end) - toMicros(start)};
+    std::lock_guard<std::mutex> lock(events_mutex);
+    events.push_back(std::move(event));
+}
+
+void TraceRecorder::addInstant(const std::string& name, const std::string& category) {
+    Event event{'i', getThreadId(), name, category, toMicros(Clock::now()), 0};
+    std::lock_guard<std::mutex> lock(events_mutex);
+    events.push_back(std::move(event));
+}
+
+std::string TraceRecorder::write(const std::filesystem::path& path) const {
+    std::ofstream file(path);
+    if(!file.is_open())
+        return "Could not open " + path.string() + " for writing the trace";
+
+    std::lock_guard<std::mutex> lock(events_mutex);
+    long pid = getpid();
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < events.size(); i++) {
+        const Event& event = events[i];
+        file << (i ? ",\n" : "\n") << "{\"ph\":\"" << event.phase << "\",\"pid\":" << pid << ",\"tid\":" << event.thread_id;
+        if(event.phase == 'M') {
+            file << ",\"name\":\"thread_name\",\"args\":{\"name\":" << jsonString(event.name) << "}}";
+            continue;
+        }
+        file << ",\"name\":" << jsonString(event.name) << ",\"cat\":" << jsonString(event.category) << ",\"ts\":" << event.ts_us;
+        if(event.phase == 'X')
+            file << ",\"dur\":" << event.dur_us;
+        else
+            file << ",\"s\":\"t\"";
+        file << "}";
+    }
+    file << "\n]}\n";
+    return "";
+}
@@ -0,0 +1,86 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+/**
+ * @file TraceRecorder.h
+ * @brief This file contains the declaration of the TraceRecorder class, which records a timeline of a batch as Chrome trace events.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The TraceRecorder class collects spans and instant events per thread, and writes them as Chrome trace-event JSON
+ * (open it in chrome://tracing or ui.perfetto.dev). Every method may be called from any thread.
+ */
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Records a span from its construction to its destruction on the current thread, nothing if the recorder is null.
+     */
+    class Span {
+        TraceRecorder* recorder;
+        std::string name;
+        std::string category;
+        Clock::time_point start;
+    public:
+        Span(TraceRecorder* recorder, std::string name, std::string category);
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        ~Span();
+    };
+
+    TraceRecorder();
+
+    /**
+     * @brief Gets the trace id of the current thread, threads are numbered in the order they first record something.
+     */
+    int getThreadId();
+
+    /**
+     * @brief Names the current thread in the timeline.
+     */
+    void setThreadName(const std::string& name);
+
+    /**
+     * @brief Records a span.
+     * @param thread_id The thread it ran on (getThreadId).
+     */
+    void addSpan(int thread_id, const std::string& name, const std::string& category, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Records an instant event on the current thread.
+     */
+    void addInstant(const std::string& name, const std::string& category);
+
+    /**
+     * @brief Writes the trace.
+     * @param path The JSON file.
+     * @return An error message, empty on success.
+     */
+    std::string write(const std::filesystem::path& path) const;
+
+private:
+    struct Event {
+        char phase; // X (span), i (instant) or M (thread name)
+        int thread_id;
+        std::string name;
+        std::string category;
+        long long ts_us;
+        long long dur_us;
+    };
+
+    Clock::time_point start;
+    mutable std::mutex events_mutex;
+    std::vector<Event> events;
+    int next_thread_id = 0;
+
+    long long toMicros(Clock::time_point time) const;
+};
+
+#endif // TRACE_RECORDER_H
@@ -0,0 +1,18 @@
+#ifndef VACUUM_SIM_H
+#define VACUUM_SIM_H
+
+/**
+ * @file VacuumSim.h
+ * @brief The public header of libvacuumsim, the simulator core that myrobot is built on.
+ *
+ * Houses are read into Simulator::HouseValues (Simulator::readHouseFile for files, Simulator::readHouse for in-memory data),
+ * algorithms are given as AlgorithmEntry factories (AlgorithmLoader creates them from plugins),
+ * and BatchRunner runs every task on a thread pool and returns a TaskResult per task, without any filesystem I/O.
+ */
+
+#include "House.h"
+#include "Simulator.h"
+#include "AlgorithmLoader.h"
+#include "BatchRunner.h"
+
+#endif // VACUUM_SIM_H
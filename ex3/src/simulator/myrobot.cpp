@@ -6,26 +6,202 @@
 #include <iostream>
 #include <string>
 #include <filesystem>
-#include "House.h"
-#include "Simulator.h"
 #include <regex>
-#include <dlfcn.h>
-#include <thread>
-#include "../common/AlgorithmRegistrar.h"
-#include <utility>
-#include <atomic>
-#include <mutex>
+#include "VacuumSim.h"
+#include "TaskJournal.h"
+#include "ResultCache.h"
+#include "ProgressExporter.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <sstream>
+#include <optional>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+struct TaskInfo {
+    std::string name; // the algorithm name (or manifest label) in the output file names, the summary and the journal
+    size_t replicate = 0; // its run number (from 1) of a multi-seed pair, 0 for a single run
+    bool summary_only = false;
+    bool in_shard = true; // false for the tasks of the other shards, which aren't run (or reported) by this one
+};
 
 struct RunValues{
     std::vector<Simulator::HouseValues> house_values;
-    std::vector<std::pair<std::unique_ptr<AbstractAlgorithm>, std::string>> algorithm_instances;
-    std::vector<int> results;
+    std::vector<AlgorithmEntry> algorithms;
+    std::vector<TaskResult> results;
     bool summary_only = false;
+    bool resume = false;
+    std::filesystem::path metrics_path;
+    std::filesystem::path journal_path = "summary.journal";
+    TaskJournal journal;
+    std::filesystem::path cache_path;
+    ResultCache cache;
+    std::set<std::string> recompute; // algorithms whose cached results are ignored ("all" for every algorithm)
+    std::vector<std::string> house_hashes;
+    std::vector<std::string> plugin_hashes; // empty for an algorithm that can't be cached
+    std::optional<uint64_t> seed; // the base seed every task's seed is derived from
+    size_t seeds = 0; // the number of runs of every non-deterministic house&algorithm pair, 0 for a single run
+    std::vector<bool> deterministic; // per algorithm
+    std::vector<size_t> same_house; // per house, the first house that is identical to it (itself if there's none)
+    std::vector<BatchRunner::Task> tasks;
+    std::vector<TaskInfo> task_info; // per task
+    std::filesystem::path manifest_path;
+    size_t shard_index = 0;
+    size_t shard_count = 0; // 0 when the batch isn't sharded
+    std::filesystem::path merge_path; // the directory with the journals of all the shards
+    std::filesystem::path trace_path;
+    std::unique_ptr<TraceRecorder> trace; // null without -trace_out
+    bool profile_sensors = false;
+    bool profile_steps = false;
+    std::vector<bool> profiled; // per task, whether its result has the sensor calls and step times (it was run by this process, and finished)
+    std::vector<size_t> sweep_steps; // the MaxSteps values of a sweep, empty when MaxSteps isn't swept
+    std::vector<size_t> sweep_battery; // the MaxBattery values of a sweep
+    std::filesystem::path progress_path;
+    size_t progress_interval = 10; // seconds
 };
 
+// the house's file name without extension, as used in the summary and output file names
+std::string get_house_name(const RunValues& rv, size_t house_index) {
+    return rv.house_values[house_index].house_path.filename().replace_extension("").string();
+}
+
+// the algorithm name of a task in the output file names, the summary and the journal - a multi-seed run gets a _seed<run> suffix
+std::string get_task_name(const RunValues& rv, size_t task_index) {
+    return rv.task_info[task_index].name;
+}
+
+// a task's shard depends only on its names (any stable hash of them works, deriveSeed is one),
+// so every node agrees on it however its directories happen to be listed
+size_t get_task_shard(const RunValues& rv, size_t task_index) {
+    return BatchRunner::deriveSeed(0, get_house_name(rv, rv.tasks[task_index].house_index), get_task_name(rv, task_index), 0) % rv.shard_count;
+}
+
+uint64_t derive_task_seed(const RunValues& rv, size_t house_index, size_t algorithm_index, size_t replicate) {
+    return BatchRunner::deriveSeed(*rv.seed, get_house_name(rv, house_index), rv.algorithms[algorithm_index].name, replicate);
+}
+
+// houses that only differ in their file names (copies, generator duplicates) are simulated once, see same_house
+void find_identical_houses(RunValues& rv) {
+    std::multimap<uint64_t, size_t> fingerprints;
+    for (size_t house = 0; house < rv.house_values.size(); house++) {
+        uint64_t fingerprint = Simulator::fingerprintHouse(rv.house_values[house]);
+        rv.same_house.push_back(house);
+        auto [first, last] = fingerprints.equal_range(fingerprint);
+        for (auto it = first; it != last; it++) {
+            if(Simulator::isSameHouse(rv.house_values[it->second], rv.house_values[house])) {
+                rv.same_house[house] = it->second;
+                break;
+            }
+        }
+        if(rv.same_house[house] == house)
+            fingerprints.insert({fingerprint, house});
+    }
+}
+
+// the most values a sweep range may have, a typo like 1:100000000 would otherwise quietly become that many tasks per house
+const size_t MAX_SWEEP_VALUES = 1000;
+
+// a sweep range is <first>[:<last>[:<step>]], every value from first to last (inclusive) by step (1 by default)
+bool parse_sweep_range(const std::string& range, std::vector<size_t>& values) {
+    std::regex range_pattern(R"((\d+)(?::(\d+)(?::(\d+))?)?)");
+    std::smatch matches;
+    if(!std::regex_match(range, matches, range_pattern))
+        return false;
+    try {
+        size_t first = std::stoul(matches[1]);
+        size_t last = matches[2].matched ? std::stoul(matches[2]) : first;
+        size_t step = matches[3].matched ? std::stoul(matches[3]) : 1;
+        if(first == 0 || last < first || step == 0 || (last - first) / step >= MAX_SWEEP_VALUES)
+            return false;
+        // stops before value += step could wrap around (a last near SIZE_MAX)
+        for (size_t value = first; ; value += step) {
+            values.push_back(value);
+            if(last - value < step)
+                break;
+        }
+    } catch (const std::exception& e) {
+        return false;
+    }
+    return true;
+}
+
+// -sweep=steps=<range>,battery=<range> (either one may be left out)
+bool parse_sweep(RunValues& rv, const std::string& sweep) {
+    std::stringstream parameters(sweep);
+    std::string parameter;
+    while (std::getline(parameters, parameter, ',')) {
+        size_t eq = parameter.find('=');
+        std::string name = parameter.substr(0, eq);
+        std::vector<size_t>* values = name == "steps" ? &rv.sweep_steps : (name == "battery" ? &rv.sweep_battery : nullptr);
+        if(eq == std::string::npos || !values || !values->empty() || !parse_sweep_range(parameter.substr(eq + 1), *values))
+            return false;
+    }
+    // the values are sorted, the simulator can't keep a larger battery exactly
+    if(!rv.sweep_battery.empty() && rv.sweep_battery.back() > Battery::MAX_CAPACITY)
+        return false;
+    return !rv.sweep_steps.empty() || !rv.sweep_battery.empty();
+}
+
+// a sweep runs every house with every point of the sweep (a MaxSteps&MaxBattery pair) and every algorithm, on the house's single parsed copy
+void create_sweep_tasks(RunValues& rv) {
+    // a parameter that isn't swept keeps the house's value
+    std::vector<std::optional<size_t>> steps_values(rv.sweep_steps.begin(), rv.sweep_steps.end());
+    std::vector<std::optional<size_t>> battery_values(rv.sweep_battery.begin(), rv.sweep_battery.end());
+    if(steps_values.empty())
+        steps_values.push_back(std::nullopt);
+    if(battery_values.empty())
+        battery_values.push_back(std::nullopt);
+
+    for (size_t house = 0; house < rv.house_values.size(); house++) {
+        for (auto steps : steps_values) {
+            for (auto battery : battery_values) {
+                for (size_t algorithm = 0; algorithm < rv.algorithms.size(); algorithm++) {
+                    BatchRunner::Task task{house, algorithm};
+                    task.max_steps = steps;
+                    task.battery = battery;
+                    // every point gets the same seed, so the points of a non-deterministic algorithm are compared on the same random choices
+                    if(!rv.deterministic[algorithm] && rv.seed)
+                        task.seed = derive_task_seed(rv, house, algorithm, 0);
+                    std::string name = rv.algorithms[algorithm].name;
+                    if(steps)
+                        name += "_steps" + std::to_string(*steps);
+                    if(battery)
+                        name += "_battery" + std::to_string(*battery);
+                    rv.tasks.push_back(task);
+                    rv.task_info.push_back({name});
+                }
+            }
+        }
+    }
+}
+
+// every house&algorithm pair is a single task, except for non-deterministic algorithms with -seeds which run once per seed,
+// and non-deterministic algorithms get a derived seed whenever a base seed is known
+void create_tasks(RunValues& rv) {
+    for (const auto& task : BatchRunner::crossProduct(rv.house_values.size(), rv.algorithms.size())) {
+        const std::string& name = rv.algorithms[task.algorithm_index].name;
+        if(rv.deterministic[task.algorithm_index] || !rv.seed) {
+            rv.tasks.push_back(task);
+            rv.task_info.push_back({name});
+        }
+        else if(rv.seeds == 0) {
+            rv.tasks.push_back({task.house_index, task.algorithm_index, derive_task_seed(rv, task.house_index, task.algorithm_index, 0)});
+            rv.task_info.push_back({name});
+        }
+        else {
+            for (size_t run = 1; run <= rv.seeds; run++) {
+                rv.tasks.push_back({task.house_index, task.algorithm_index, derive_task_seed(rv, task.house_index, task.algorithm_index, run)});
+                rv.task_info.push_back({name + "_seed" + std::to_string(run), run});
+            }
+        }
+    }
+}
 
-// atomic counter for task synchronization
-std::atomic<int> counter(-1);
 
 
 // extract all path names matching the given extention in the given directory
@@ -65,56 +241,297 @@ bool write_error_file(std::string filename, std::string content) {
     return false;
 }
 
+// the index of the house, reading it the first time it's used - -1 if it's invalid
+int get_manifest_house(RunValues& rv, std::map<std::filesystem::path, int>& house_indices, const std::filesystem::path& house_path) {
+    auto it = house_indices.find(house_path);
+    if(it != house_indices.end())
+        return it->second;
 
-// this function is run by every thread that runs tasks (task is a house&algorithm combination)
-void run_simulations(RunValues& rv) {
-    size_t my_task;
-    std::mutex results_mutex;
-    std::deque<std::jthread> timeout_threads;
-    while((my_task = ++counter) < rv.algorithm_instances.size()) {
-        Simulator simulator;        
-        simulator.setHouseValues(rv.house_values[my_task / (rv.algorithm_instances.size() / rv.house_values.size())]);
-        simulator.setAlgorithm(std::move(rv.algorithm_instances[my_task].first));
-        simulator.setAlgorithmName(rv.algorithm_instances[my_task].second);
-
-        auto timeout = std::chrono::milliseconds(simulator.getMaxSteps());
-
-        // create a backup timeout thread
-        timeout_threads.emplace_back([&rv, my_task, &simulator, timeout, &results_mutex]() {           
-            std::this_thread::sleep_for(timeout);
-            std::unique_lock<std::mutex> lck(results_mutex);
-            if(rv.results[my_task] == -1) {
-                simulator.rres.timeout_reached = true;
-                rv.results[my_task] = simulator.calcScoreAndWriteResults(!rv.summary_only);
-                lck.unlock(); // this line is important
-                // the backup thread effectively replaces the original task thread here by running tasks instead of it
-                run_simulations(rv);
-            }
-        });
-
-        std::string err = simulator.run();
-        std::lock_guard<std::mutex> lock(results_mutex);
-        // equivalent to saying "if nobody written this task's score yet"
-        if(rv.results[my_task] == -1) {
-            // we usually reach here
-            if(err != "" ) {
-                write_error_file(simulator.getAlgorithmName() + ".error", "Failed to run algorithm on " + simulator.getHousePath().filename().string() + ": " + err + "\n");
+    TraceRecorder::Span span(rv.trace.get(), "parse " + house_path.filename().string(), "parse");
+    Simulator::HouseValues hv = Simulator::readHouseFile(house_path);
+    if(hv.error_message != "") {
+        write_error_file(house_path.filename().replace_extension("error"), "Error in house file: " + hv.error_message);
+        return house_indices[house_path] = -1;
+    }
+    rv.house_values.push_back(std::move(hv));
+    return house_indices[house_path] = rv.house_values.size() - 1;
+}
+
+// a manifest line is a task: house=<file> algorithm=<name> [label=<name>] [max_steps=<N>] [battery=<N>] [seed=<S>] [repeat=<N>] [summary_only]
+// house files are relative to house_dir, a task with an invalid house gets an error file instead, like in a directory run
+std::string read_manifest(RunValues& rv, const std::filesystem::path& house_dir) {
+    std::ifstream file(rv.manifest_path);
+    if(!file.is_open())
+        return "Could not open the manifest " + rv.manifest_path.string();
+
+    std::map<std::string, size_t> algorithm_indices;
+    for (size_t i = 0; i < rv.algorithms.size(); i++) {
+        algorithm_indices[rv.algorithms[i].name] = i;
+    }
+    std::map<std::filesystem::path, int> house_indices;
+
+    std::string line;
+    for (size_t line_num = 1; std::getline(file, line); line_num++) {
+        std::stringstream words(line);
+        std::string word;
+        std::map<std::string, std::string> fields;
+        bool summary_only = false;
+        while(words >> word && word[0] != '#') {
+            size_t eq = word.find('=');
+            if(word == "summary_only")
+                summary_only = true;
+            else if(eq == std::string::npos || !fields.emplace(word.substr(0, eq), word.substr(eq + 1)).second)
+                return rv.manifest_path.string() + ":" + std::to_string(line_num) + ": Invalid field " + word;
+        }
+        if(fields.empty() && !summary_only)
+            continue; // an empty or comment line
+
+        std::string error = "";
+        auto number = [&](const std::string& key) -> std::optional<uint64_t> {
+            if(!fields.count(key))
+                return std::nullopt;
+            try {
+                size_t end;
+                uint64_t value = std::stoull(fields[key], &end);
+                if(end == fields[key].size())
+                    return value;
+            } catch (const std::exception& e) {}
+            error = "Invalid " + key + " " + fields[key];
+            return std::nullopt;
+        };
+        std::optional<uint64_t> max_steps = number("max_steps"), battery = number("battery"), seed = number("seed"), repeat = number("repeat");
+        if(battery && *battery > Battery::MAX_CAPACITY)
+            error = "Invalid battery " + fields["battery"] + ", at most " + std::to_string(Battery::MAX_CAPACITY);
+        for (const auto& field : fields) {
+            if(field.first != "house" && field.first != "algorithm" && field.first != "label" && field.first != "max_steps"
+               && field.first != "battery" && field.first != "seed" && field.first != "repeat")
+                error = "Unknown field " + field.first;
+        }
+        if(!fields.count("house") || !fields.count("algorithm"))
+            error = "A task needs a house and an algorithm";
+        else if(!algorithm_indices.count(fields["algorithm"]))
+            error = "Unknown algorithm " + fields["algorithm"];
+        if(error != "")
+            return rv.manifest_path.string() + ":" + std::to_string(line_num) + ": " + error;
+
+        std::filesystem::path house_path = fields["house"];
+        if(house_path.is_relative())
+            house_path = house_dir / house_path;
+        int house_index = get_manifest_house(rv, house_indices, house_path);
+        if(house_index == -1)
+            continue;
+
+        size_t algorithm_index = algorithm_indices[fields["algorithm"]];
+        std::string label = fields.count("label") ? fields["label"] : fields["algorithm"];
+        std::string house_name = get_house_name(rv, house_index);
+        size_t runs = repeat.value_or(1);
+        // a repeated task is a weighted task, each of its runs gets its own name (and seed)
+        for (size_t run = 1; run <= runs; run++) {
+            BatchRunner::Task task{(size_t)house_index, algorithm_index};
+            task.max_steps = max_steps;
+            task.battery = battery;
+            if(!rv.deterministic[algorithm_index]) {
+                if(seed && runs == 1)
+                    task.seed = seed;
+                else if(seed || rv.seed)
+                    task.seed = BatchRunner::deriveSeed(seed ? *seed : *rv.seed, house_name, label, runs == 1 ? 0 : run);
             }
-            else
-                rv.results[my_task] = simulator.calcScoreAndWriteResults(!rv.summary_only);
-        } 
+            rv.tasks.push_back(task);
+            rv.task_info.push_back({runs == 1 ? label : label + "_" + std::to_string(run), 0, summary_only});
+        }
+    }
+    return "";
+}
+
+// writes the output file (unless summary_only) and the log file of a task that is done, called by the worker thread that ran the task
+void write_task_files(const RunValues& rv, size_t task_index, TaskResult& result) {
+    const BatchRunner::Task& task = rv.tasks[task_index];
+    std::string algo_name = get_task_name(rv, task_index);
+    std::string house_name = get_house_name(rv, task.house_index);
+
+    if(result.error_message != "") {
+        algo_name = rv.algorithms[task.algorithm_index].name;
+        write_error_file(algo_name + ".error", "Failed to run algorithm on " + house_name + ".house: " + result.error_message + "\n");
+        return;
+    }
+
+    if(!rv.summary_only && !rv.task_info[task_index].summary_only) {
+        std::ofstream output_file(house_name + "-" + algo_name + ".txt");
+        if (!output_file) {
+            std::cerr << "Failed to open the output file" << std::endl;
+        }
         else {
-            // we only reach here when the simulator finished after timeout and another thread replaced the current thread
-            break;
+            output_file << "NumSteps = " << result.num_steps << std::endl;
+            output_file << "DirtLeft = " << result.dirt_left << std::endl;
+            output_file << "Status = " << result.status << std::endl;
+            output_file << "InDock = " << (result.in_dock ? "TRUE" : "FALSE") << std::endl;
+            output_file << "Score = " << result.score << std::endl;
+            output_file << "Steps:" << std::endl;
+            output_file << result.steps << std::endl;
         }
     }
+
+    // results taken from the cache have no log
+    if(result.log != "") {
+        std::ofstream log_file(house_name + "-" + algo_name + ".log");
+        if (!log_file) {
+            std::cerr << "Failed to open the output file" << std::endl;
+            return;
+        }
+        log_file << result.log;
+    }
+
+    // the files are written, no need to keep the streams in memory until the batch ends
+    result.steps.clear();
+    result.steps.shrink_to_fit();
+    result.log.clear();
+    result.log.shrink_to_fit();
+}
+
+// the cache key of a task, empty if the task can't be cached - a seeded task is as reproducible as a deterministic one
+std::string get_cache_key(const RunValues& rv, const BatchRunner::Task& task) {
+    if(rv.cache_path.empty() || rv.house_hashes[task.house_index] == "" || rv.plugin_hashes[task.algorithm_index] == "")
+        return "";
+    std::string key = ResultCache::makeKey(rv.house_hashes[task.house_index], rv.plugin_hashes[task.algorithm_index]);
+    if(task.max_steps)
+        key += "-m" + std::to_string(*task.max_steps);
+    if(task.battery)
+        key += "-b" + std::to_string(*task.battery);
+    return task.seed ? key + "-s" + std::to_string(*task.seed) : key;
+}
+
+// hashes every house file and plugin once and opens the cache, when -cache is given
+bool prepare_cache(RunValues& rv) {
+    if(rv.cache_path.empty())
+        return true;
+
+    std::string err = rv.cache.open(rv.cache_path);
+    if(err != "") {
+        std::cerr << err << std::endl;
+        return false;
+    }
+    for (const auto& hv : rv.house_values) {
+        rv.house_hashes.push_back(ResultCache::hashFile(hv.house_path));
+    }
+    // an algorithm compiled into myrobot-static changes with the program itself
+    std::string program_hash;
+    for (const auto& algo : rv.algorithms) {
+        if(algo.plugin_path.empty() && program_hash.empty())
+            program_hash = ResultCache::hashFile("/proc/self/exe");
+        rv.plugin_hashes.push_back(algo.plugin_path.empty() ? program_hash : ResultCache::hashFile(algo.plugin_path));
+    }
+    return true;
+}
+
+// a summary cell of a multi-seed pair, the sample standard deviation is 0 for a single seed
+std::string format_seed_stats(const RunValues& rv, const std::vector<size_t>& task_indices) {
+    double sum = 0;
+    int min = rv.results[task_indices[0]].score;
+    int max = min;
+    for (size_t task : task_indices) {
+        int score = rv.results[task].score;
+        sum += score;
+        min = std::min(min, score);
+        max = std::max(max, score);
+    }
+    double mean = sum / task_indices.size();
+    double squares = 0;
+    for (size_t task : task_indices) {
+        squares += (rv.results[task].score - mean) * (rv.results[task].score - mean);
+    }
+    double sd = task_indices.size() > 1 ? std::sqrt(squares / (task_indices.size() - 1)) : 0;
+
+    char cell[128];
+    std::snprintf(cell, sizeof(cell), "mean=%.2f;sd=%.2f;min=%d;max=%d", mean, sd, min, max);
+    return cell;
+}
+
+// the sensor calls of every algorithm over all of its tasks that were profiled, per sensor
+bool write_sensor_profile_file(const RunValues& rv) {
+    std::ofstream file("sensor_profile.csv");
+    if (!file.is_open()) {
+        std::cerr << "Could not open sensor_profile.csv for writing" << std::endl;
+        return false;
+    }
+    file << "algorithm,sensor,tasks,steps,calls,calls_per_step,ns_per_call\n";
+    for (size_t algorithm = 0; algorithm < rv.algorithms.size(); algorithm++) {
+        size_t tasks = 0, steps = 0;
+        std::array<Simulator::SensorStats, Simulator::SENSORS_NUM> total;
+        for (size_t task = 0; task < rv.tasks.size(); task++) {
+            if(rv.tasks[task].algorithm_index != algorithm || !rv.profiled[task])
+                continue;
+            tasks++;
+            // the Finish step is a nextStep call too
+            steps += rv.results[task].num_steps + 1;
+            for (int sensor = 0; sensor < Simulator::SENSORS_NUM; sensor++) {
+                total[sensor].calls += rv.results[task].sensor_stats[sensor].calls;
+                total[sensor].time += rv.results[task].sensor_stats[sensor].time;
+            }
+        }
+        for (int sensor = 0; sensor < Simulator::SENSORS_NUM; sensor++) {
+            char rates[64];
+            std::snprintf(rates, sizeof(rates), "%.3f,%.1f", steps ? double(total[sensor].calls) / steps : 0.0,
+                          total[sensor].calls ? double(total[sensor].time.count()) / total[sensor].calls : 0.0);
+            file << rv.algorithms[algorithm].name << "," << Simulator::getSensorName(Simulator::Sensor(sensor)) << ","
+                 << tasks << "," << steps << "," << total[sensor].calls << "," << rates << "\n";
+        }
+    }
+    return true;
+}
+
+// a sweep's summary has a row per house and sweep point, with a column per algorithm
+bool write_sweep_summary_file(const RunValues& rv) {
+    std::ofstream file("summary.csv");
+    if (!file.is_open()) {
+        std::cerr << "Could not open the file for writing" << std::endl;
+        return false;
+    }
+    file << "house,max_steps,max_battery";
+    for (const auto& algo : rv.algorithms) {
+        file << "," << algo.name;
+    }
+    file << "\n";
+    // the tasks were created a row at a time, with the algorithms in order
+    size_t algo_num = rv.algorithms.size();
+    for (size_t row = 0; algo_num && row < rv.tasks.size() / algo_num; row++) {
+        const BatchRunner::Task& task = rv.tasks[row * algo_num];
+        const Simulator::HouseValues& hv = rv.house_values[task.house_index];
+        file << get_house_name(rv, task.house_index) << "," << task.max_steps.value_or(hv.maxSteps) << "," << task.battery.value_or(hv.battery_capacity);
+        for (size_t algorithm = 0; algorithm < algo_num; algorithm++) {
+            file << "," << rv.results[row * algo_num + algorithm].score;
+        }
+        file << "\n";
+    }
+    return true;
+}
+
+// a manifest's tasks don't make a house by algorithm table, so its summary has a row per task
+bool write_manifest_summary_file(const RunValues& rv) {
+    std::ofstream file("summary.csv");
+    if (!file.is_open()) {
+        std::cerr << "Could not open the file for writing" << std::endl;
+        return false;
+    }
+    file << "house,task,algorithm,score\n";
+    for (size_t task = 0; task < rv.tasks.size(); task++) {
+        file << get_house_name(rv, rv.tasks[task].house_index) << ","
+             << get_task_name(rv, task) << ","
+             << rv.algorithms[rv.tasks[task].algorithm_index].name << ","
+             << rv.results[task].score << "\n";
+    }
+    return true;
 }
 
 bool write_results_csv_file(const RunValues& rv) {
+    if(!rv.manifest_path.empty())
+        return write_manifest_summary_file(rv);
+    if(!rv.sweep_steps.empty() || !rv.sweep_battery.empty())
+        return write_sweep_summary_file(rv);
+
     std::ofstream file("summary.csv");
     
     if (file.is_open()) {
-        if(rv.algorithm_instances.size()) {
+        if(rv.results.size()) {
             // Write the header row (starting with an empty cell for the algorithm names)
             file << ",";
 
@@ -124,12 +541,23 @@ bool write_results_csv_file(const RunValues& rv) {
             file << "\n";
 
             // write a row for each algorithm
-            size_t algo_num = rv.algorithm_instances.size() / rv.house_values.size();
+            size_t algo_num = rv.algorithms.size();
+
+            // the tasks of each house&algorithm pair, more than one for a multi-seed pair
+            std::vector<std::vector<size_t>> cells(rv.house_values.size() * algo_num);
+            for (size_t task = 0; task < rv.tasks.size(); task++) {
+                cells[rv.tasks[task].house_index * algo_num + rv.tasks[task].algorithm_index].push_back(task);
+            }
 
             for (size_t i = 0; i < algo_num; i++) {
-                file << rv.algorithm_instances[i].second << ",";
+                file << rv.algorithms[i].name << ",";
                 for (size_t j = 0; j < rv.house_values.size(); j++) {
-                    file << rv.results[j*algo_num + i] << (j+1 < rv.house_values.size() ? "," : "");
+                    const std::vector<size_t>& cell = cells[j*algo_num + i];
+                    if(rv.task_info[cell[0]].replicate)
+                        file << format_seed_stats(rv, cell);
+                    else
+                        file << rv.results[cell[0]].score;
+                    file << (j+1 < rv.house_values.size() ? "," : "");
                 }
                 file << "\n";
             }
@@ -146,6 +574,64 @@ bool write_results_csv_file(const RunValues& rv) {
     return true;
 }
 
+// one row per task, columns are only ever appended so files of different commits stay comparable
+bool write_metrics_csv_file(const RunValues& rv) {
+    std::ofstream file(rv.metrics_path);
+
+    if (!file.is_open()) {
+        std::cerr << "Could not open " << rv.metrics_path << " for writing metrics" << std::endl;
+        return false;
+    }
+
+    file << "house,algorithm,score,num_steps,status,duration_us,steps_per_sec,peak_rss_kb,seed";
+    // the counters of the algorithm's nextStep calls, then of the rest of the simulation (empty where unavailable)
+    for (const char* portion : {"algo_", "sim_"}) {
+        for (int counter = 0; counter < PerfCounters::COUNTERS_NUM; counter++) {
+            file << "," << portion << PerfCounters::getName(PerfCounters::Counter(counter));
+        }
+    }
+    file << ",algo_peak_bytes";
+    for (int sensor = 0; sensor < Simulator::SENSORS_NUM; sensor++) {
+        file << "," << Simulator::getSensorName(Simulator::Sensor(sensor)) << "_calls," << Simulator::getSensorName(Simulator::Sensor(sensor)) << "_ns";
+    }
+    file << ",step_p50_ns,step_p99_ns";
+    file << "\n";
+
+    for (size_t task = 0; task < rv.results.size(); task++) {
+        if(!rv.task_info[task].in_shard)
+            continue;
+        const TaskResult& result = rv.results[task];
+        double seconds = result.duration.count() / 1e6;
+        file << get_house_name(rv, rv.tasks[task].house_index) << ","
+             << get_task_name(rv, task) << ","
+             << result.score << ","
+             << result.num_steps << ","
+             << result.getOutcome() << ","
+             << result.duration.count() << ","
+             << (seconds > 0 ? (long long)(result.num_steps / seconds) : 0) << ","
+             << result.peak_rss_kb << ","
+             << (rv.tasks[task].seed ? std::to_string(*rv.tasks[task].seed) : "");
+        for (const auto* counts : {&result.algorithm_counts, &result.simulator_counts}) {
+            for (auto value : counts->values) {
+                file << "," << (value == -1 ? "" : std::to_string(value));
+            }
+        }
+        file << "," << (result.algorithm_peak_bytes ? std::to_string(*result.algorithm_peak_bytes) : "");
+        for (const auto& stats : result.sensor_stats) {
+            if(rv.profile_sensors && rv.profiled[task])
+                file << "," << stats.calls << "," << stats.time.count();
+            else
+                file << ",,";
+        }
+        if(rv.profile_steps && rv.profiled[task])
+            file << "," << result.step_p50.count() << "," << result.step_p99.count();
+        else
+            file << ",,";
+        file << "\n";
+    }
+    return true;
+}
+
 
 /**
  * @brief The main function of the program.
@@ -155,22 +641,48 @@ bool write_results_csv_file(const RunValues& rv) {
  * @return int The exit status of the program.
  */
 int main(int argc, char** argv) {
-	Simulator simulator;
-    std::string houseFilePath;
     std::regex house_path_pattern(R"(-house_path=([^ ]+))");
     std::regex algo_path_pattern(R"(-algo_path=([^ ]+))");
     std::regex summary_only_pattern(R"(-summary_only)");
     std::regex num_threads_pattern(R"(-num_threads=(\d+))");
-    std::regex arg_patterns[4] = {house_path_pattern, algo_path_pattern, summary_only_pattern, num_threads_pattern};
+    std::regex metrics_out_pattern(R"(-metrics_out=([^ ]+))");
+    std::regex resume_pattern(R"(-resume)");
+    std::regex journal_pattern(R"(-journal=([^ ]+))");
+    std::regex cache_pattern(R"(-cache=([^ ]+))");
+    std::regex recompute_pattern(R"(-recompute=([^ ]+))");
+    std::regex seed_pattern(R"(-seed=(\d+))");
+    std::regex seeds_pattern(R"(-seeds=(\d+))");
+    std::regex affinity_pattern(R"(-affinity)");
+    std::regex manifest_pattern(R"(-manifest=([^ ]+))");
+    std::regex shard_pattern(R"(-shard=(\d+)/(\d+))");
+    std::regex merge_pattern(R"(-merge=([^ ]+))");
+    std::regex perf_counters_pattern(R"(-perf_counters)");
+    std::regex trace_out_pattern(R"(-trace_out=([^ ]+))");
+    std::regex progress_out_pattern(R"(-progress_out=([^ ]+))");
+    std::regex progress_interval_pattern(R"(-progress_interval=(\d+))");
+    std::regex memory_limit_pattern(R"(-memory_limit=(\d+)([KMG]?))");
+    std::regex sweep_pattern(R"(-sweep=([^ ]+))");
+    std::regex profile_sensors_pattern(R"(-profile_sensors)");
+    std::regex profile_steps_pattern(R"(-profile_steps)");
+    std::regex arg_patterns[] = {house_path_pattern, algo_path_pattern, summary_only_pattern, num_threads_pattern, metrics_out_pattern,
+                                 resume_pattern, journal_pattern, cache_pattern, recompute_pattern, seed_pattern, seeds_pattern,
+                                 affinity_pattern, manifest_pattern, shard_pattern, merge_pattern,
+                                 perf_counters_pattern, trace_out_pattern, progress_out_pattern, progress_interval_pattern,
+                                 memory_limit_pattern, sweep_pattern, profile_sensors_pattern, profile_steps_pattern};
     std::filesystem::path algo_path = std::filesystem::current_path();
     std::filesystem::path house_path = std::filesystem::current_path();
-    size_t num_threads = 10;
+    size_t num_threads = 0; // BatchRunner::defaultThreadCount()
+    bool affinity = false;
+    bool perf_counters = false;
+    size_t memory_limit = 0; // bytes, no limit
     std::filesystem::path* vals[2] = {&house_path, &algo_path};
     std::string args;
+    // declared before rv, so the algorithm factories are gone before the plugins are closed on every return
+    AlgorithmLoader loader;
     RunValues rv;
 
     // Check the number of arguments
-    if (argc > 5) {
+    if (argc > (int)std::size(arg_patterns) + 1) {
         std::cerr << "Too many arguments!" << std::endl;
         return EXIT_FAILURE;
     }
@@ -196,6 +708,101 @@ int main(int argc, char** argv) {
                     std::cerr << "Error: Number out of range" << std::endl;
                 }
             }
+            else if(p==4) {
+                rv.metrics_path = matches[1].str();
+            }
+            else if(p==5) {
+                rv.resume = true;
+            }
+            else if(p==6) {
+                rv.journal_path = matches[1].str();
+            }
+            else if(p==7) {
+                rv.cache_path = matches[1].str();
+            }
+            else if(p==8) {
+                std::stringstream names(matches[1].str());
+                std::string name;
+                while (std::getline(names, name, ','))
+                    rv.recompute.insert(name);
+            }
+            else if(p==9 || p==10) {
+                try {
+                    if(p==9)
+                        rv.seed = std::stoull(matches[1]);
+                    else
+                        rv.seeds = std::stoull(matches[1]);
+                } catch (std::out_of_range& e) {
+                    std::cerr << "Error: Number out of range" << std::endl;
+                }
+            }
+            else if(p==11) {
+                affinity = true;
+            }
+            else if(p==12) {
+                rv.manifest_path = matches[1].str();
+            }
+            else if(p==13) {
+                try {
+                    rv.shard_index = std::stoul(matches[1]);
+                    rv.shard_count = std::stoul(matches[2]);
+                } catch (std::out_of_range& e) {
+                    std::cerr << "Error: Number out of range" << std::endl;
+                }
+                if(rv.shard_index >= rv.shard_count) {
+                    std::cerr << "Error: -shard=i/n needs 0 <= i < n" << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else if(p==14) {
+                rv.merge_path = matches[1].str();
+            }
+            else if(p==15) {
+                perf_counters = true;
+            }
+            else if(p==16) {
+                rv.trace_path = matches[1].str();
+            }
+            else if(p==17) {
+                rv.progress_path = matches[1].str();
+            }
+            else if(p==18) {
+                try {
+                    rv.progress_interval = std::stoul(matches[1]);
+                } catch (const std::exception& e) {
+                    rv.progress_interval = 0;
+                }
+                if(rv.progress_interval == 0) {
+                    std::cerr << "Error: -progress_interval must be a positive number of seconds" << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else if(p==19) {
+                try {
+                    std::string unit = matches[2].str();
+                    int shift = unit == "K" ? 10 : unit == "M" ? 20 : unit == "G" ? 30 : 0;
+                    size_t value = std::stoul(matches[1]);
+                    // the shift would drop the high bits silently
+                    if(value > SIZE_MAX >> shift)
+                        throw std::out_of_range("memory_limit");
+                    memory_limit = value << shift;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Number out of range" << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else if(p==20) {
+                if(!parse_sweep(rv, matches[1].str())) {
+                    std::cerr << "Error: Invalid sweep " << matches[1].str() << ", expected steps=<first>[:<last>[:<step>]],battery=<first>[:<last>[:<step>]] of at most " << MAX_SWEEP_VALUES << " values each, and battery values at most " << Battery::MAX_CAPACITY << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else if(p==21) {
+                rv.profile_sensors = true;
+            }
+            else if(p==22) {
+                rv.profile_steps = true;
+            }
             else {
                 try {
                     *(vals[p]) = matches[1];
@@ -208,12 +815,39 @@ int main(int argc, char** argv) {
         }
     }
 
-    // get all .house files
-    std::vector<std::filesystem::path> house_paths = get_file_path_list_from_dir(house_path, ".house");
+    if(!rv.trace_path.empty()) {
+        rv.trace = std::make_unique<TraceRecorder>();
+        rv.trace->setThreadName("main");
+    }
+
+    // every shard (and the merge) must derive the same seeds
+    if(rv.seeds && !rv.seed && (rv.shard_count || !rv.merge_path.empty())) {
+        std::cerr << "Error: -seeds needs -seed with -shard or -merge" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(rv.shard_count && !rv.merge_path.empty()) {
+        std::cerr << "Error: -shard and -merge can't be used together" << std::endl;
+        return EXIT_FAILURE;
+    }
+    bool sweep = !rv.sweep_steps.empty() || !rv.sweep_battery.empty();
+    if(sweep && (rv.seeds || !rv.manifest_path.empty())) {
+        std::cerr << "Error: -sweep can't be used with -seeds or -manifest" << std::endl;
+        return EXIT_FAILURE;
+    }
+    // a shard keeps its journal, it's the shard's result for the merge
+    if(rv.shard_count && rv.journal_path == "summary.journal") {
+        rv.journal_path = "shard_" + std::to_string(rv.shard_index) + "_of_" + std::to_string(rv.shard_count) + ".journal";
+    }
+
+    // get all .house files (a manifest names its own house files instead)
+    std::vector<std::filesystem::path> house_paths;
+    if(rv.manifest_path.empty())
+        house_paths = get_file_path_list_from_dir(house_path, ".house");
 
     // read and validate each .house file exactly once
     for (auto house_path : house_paths)
     {
+        TraceRecorder::Span span(rv.trace.get(), "parse " + house_path.filename().string(), "parse");
         Simulator::HouseValues hv = std::move(Simulator::readHouseFile(house_path));
         if(hv.error_message == "")
             rv.house_values.push_back(std::move(hv));
@@ -221,68 +855,195 @@ int main(int argc, char** argv) {
             write_error_file(house_path.filename().replace_extension("error"), "Error in house file: " + hv.error_message);
     }
     
-    // get all .so files
-    std::vector<std::filesystem::path> algo_file_paths = get_file_path_list_from_dir(algo_path, ".so");
-    
-    std::vector<void*> handles;
-    handles.reserve(algo_file_paths.size());
-
-    // dlopen each .so file
-    for (auto path : algo_file_paths)
+    // get all .so files and dlopen each of them
+    for (const auto& so_path : get_file_path_list_from_dir(algo_path, ".so"))
     {
+        TraceRecorder::Span span(rv.trace.get(), "load " + so_path.filename().string(), "load");
+        std::string load_error = loader.load(so_path);
+        if(load_error != "")
+            write_error_file(so_path.filename().replace_extension("error"), load_error);
+    }
+    rv.algorithms = loader.getAlgorithms();
+    for (const auto& algo : rv.algorithms) {
+        rv.deterministic.push_back(Simulator::isDeterministic(*algo.factory()));
+    }
 
-        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
-        if(!handle) {
-            write_error_file(path.filename().replace_extension("error"), "Failed to open library: " + std::string(dlerror()));
-            continue;
+    // without -seed a multi-seed run still needs a base seed, it's printed so the run can be repeated
+    if(rv.seeds && !rv.seed) {
+        rv.seed = (uint64_t(std::random_device()()) << 32) | std::random_device()();
+        std::cout << "Using -seed=" << *rv.seed << std::endl;
+    }
+    find_identical_houses(rv);
+    if(sweep) {
+        create_sweep_tasks(rv);
+    }
+    else if(rv.manifest_path.empty()) {
+        create_tasks(rv);
+    }
+    else {
+        std::string manifest_error = read_manifest(rv, house_path);
+        if(manifest_error != "") {
+            std::cerr << manifest_error << std::endl;
+            return EXIT_FAILURE;
         }
+    }
 
-        // Clear any existing errors
-        dlerror();
-        
-        handles.push_back(handle);
-
-        if(AlgorithmRegistrar::getAlgorithmRegistrar().count() != handles.size()) {
-            write_error_file(path.filename().replace_extension("error"), "Failed to register algorithm");
-            continue;
+    // a merge runs no task, it only reads the results of the shards
+    if(!rv.merge_path.empty()) {
+        for (const auto& journal_path : get_file_path_list_from_dir(rv.merge_path, ".journal")) {
+            rv.journal.load(journal_path);
         }
+    }
+    else {
+        std::string journal_error = rv.journal.open(rv.journal_path, rv.resume);
+        if(journal_error != "") {
+            std::cerr << journal_error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
+    if(!prepare_cache(rv)) {
+        return EXIT_FAILURE;
     }
 
+    // tasks that are in the journal already were done by a previous (killed) run, and tasks that are in the cache
+    // were done by an earlier run on the same house and plugin - only the others are run
+    std::vector<BatchRunner::Task> pending_tasks;
+    std::vector<size_t> pending_task_indices;
+    // a deterministic algorithm gets the same result on identical houses, so a task on a copy of a pending task's house isn't run,
+    // it's an alias that gets the pending task's result (the tasks' overrides must match too)
+    std::map<std::tuple<size_t, size_t, std::optional<size_t>, std::optional<size_t>>, size_t> shared_tasks; // to the pending task
+    std::vector<std::vector<size_t>> pending_task_aliases;
+    std::vector<std::string> missing_tasks; // by the merge
+    rv.results.resize(rv.tasks.size());
+    for (size_t i = 0; i < rv.tasks.size(); i++) {
+        std::string house_name = get_house_name(rv, rv.tasks[i].house_index);
+        std::string algo_name = get_task_name(rv, i);
+        if(rv.shard_count && get_task_shard(rv, i) != rv.shard_index) {
+            rv.task_info[i].in_shard = false;
+            continue;
+        }
+        if(rv.journal.find(house_name, algo_name, rv.results[i]))
+            continue;
+        if(!rv.merge_path.empty()) {
+            missing_tasks.push_back(house_name + "-" + algo_name);
+            continue;
+        }
 
-    // create num_houses instances of each algorithm that registered susccefully
-    for (size_t i = 0; i < rv.house_values.size(); i++) {
-        for(const auto& algo: AlgorithmRegistrar::getAlgorithmRegistrar()) {
-            rv.algorithm_instances.emplace_back(algo.create(), algo.name());
+        // recomputed (non-deterministic) algorithms still refresh the cache with their new result
+        bool recompute = rv.recompute.count("all") || rv.recompute.count(rv.algorithms[rv.tasks[i].algorithm_index].name);
+        std::string cache_key = get_cache_key(rv, rv.tasks[i]);
+        if(cache_key != "" && !recompute && rv.cache.find(cache_key, rv.results[i])) {
+            write_task_files(rv, i, rv.results[i]);
+            rv.journal.append(house_name, algo_name, rv.results[i]);
+            continue;
+        }
+        const BatchRunner::Task& task = rv.tasks[i];
+        if(rv.deterministic[task.algorithm_index] && !task.seed) {
+            auto [shared, inserted] = shared_tasks.insert({{rv.same_house[task.house_index], task.algorithm_index, task.max_steps, task.battery}, pending_tasks.size()});
+            if(!inserted) {
+                pending_task_aliases[shared->second].push_back(i);
+                continue;
+            }
         }
+        pending_tasks.push_back(task);
+        pending_task_indices.push_back(i);
+        pending_task_aliases.emplace_back();
     }
-    rv.results.resize(rv.algorithm_instances.size(), -1);
 
-    std::vector<std::thread> threads;
-    threads.reserve(num_threads);
+    if(!missing_tasks.empty()) {
+        std::cerr << "Error: " << missing_tasks.size() << " tasks are missing from the journals in " << rv.merge_path << ", like " << missing_tasks[0]
+                  << " (did every shard finish?)" << std::endl;
+        return EXIT_FAILURE;
+    }
 
-    // creating the actual working threads (that run our tasks)
-    for (size_t i = 0; i < num_threads; i++) {
-        threads.emplace_back(run_simulations, std::ref(rv));
+    BatchOptions options;
+    options.num_threads = num_threads;
+    options.affinity = affinity;
+    options.perf_counters = perf_counters;
+    options.memory_limit = memory_limit;
+    options.profile_sensors = rv.profile_sensors;
+    options.profile_steps = rv.profile_steps;
+    options.trace = rv.trace.get();
+    if(perf_counters && !PerfCounters().open()) {
+        std::cerr << "Warning: perf_event_open isn't available, the metrics will have no counters" << std::endl;
     }
+    options.record_steps = !rv.summary_only || !rv.cache_path.empty();
+    options.record_log = true;
+    options.on_task_done = [&rv, &pending_task_indices, &pending_task_aliases](size_t task_index, TaskResult& result) {
+        auto finish = [&rv](size_t task, TaskResult& task_result) {
+            std::string cache_key = get_cache_key(rv, rv.tasks[task]);
+            if(cache_key != "")
+                rv.cache.store(cache_key, task_result);
+            write_task_files(rv, task, task_result);
+            rv.journal.append(get_house_name(rv, rv.tasks[task].house_index), get_task_name(rv, task), task_result);
+        };
+        // the aliases get copies, before writing the task's files drops its steps and log
+        for (size_t alias : pending_task_aliases[task_index]) {
+            TaskResult alias_result = result;
+            finish(alias, alias_result);
+            rv.results[alias] = std::move(alias_result);
+        }
+        finish(pending_task_indices[task_index], result);
+    };
 
-    for (auto& thread : threads) {
-        thread.join();
+    std::vector<TaskResult> pending_results;
+    {
+        BatchRunner runner(rv.house_values, rv.algorithms, options);
+        // the tasks of this run that the journal or the cache already had are done from the start
+        std::optional<ProgressExporter> exporter;
+        if(!rv.progress_path.empty()) {
+            size_t in_shard = std::count_if(rv.task_info.begin(), rv.task_info.end(), [](const TaskInfo& info) { return info.in_shard; });
+            exporter.emplace(runner, rv.progress_path, std::chrono::seconds(rv.progress_interval), in_shard, in_shard - pending_tasks.size());
+        }
+        TraceRecorder::Span span(rv.trace.get(), "wait for the workers", "idle");
+        pending_results = runner.run(pending_tasks);
+    }
+    rv.profiled.assign(rv.tasks.size(), false);
+    for (size_t i = 0; i < pending_results.size(); i++) {
+        // the aliases of a task got copies of its result, sensor calls and step times included
+        bool profiled = (rv.profile_sensors || rv.profile_steps) && pending_results[i].getOutcome() != "ERROR" && pending_results[i].getOutcome() != "TIMEOUT";
+        rv.profiled[pending_task_indices[i]] = profiled;
+        for (size_t alias : pending_task_aliases[i]) {
+            rv.profiled[alias] = profiled;
+        }
+        rv.results[pending_task_indices[i]] = std::move(pending_results[i]);
     }
     
-    if(!write_results_csv_file(rv)) {
+    // a shard's summary is its journal, only the merge writes summary.csv
+    if(!rv.shard_count) {
+        TraceRecorder::Span span(rv.trace.get(), "write summary", "write");
+        if(!write_results_csv_file(rv)) {
+            return EXIT_FAILURE;
+        } 
+        // the summary is complete, there's nothing left to resume
+        if(rv.merge_path.empty())
+            rv.journal.remove();
+    }
+
+    if(!rv.metrics_path.empty() && !write_metrics_csv_file(rv)) {
         return EXIT_FAILURE;
-    } 
+    }
+
+    if(rv.profile_sensors && !write_sensor_profile_file(rv)) {
+        return EXIT_FAILURE;
+    }
 
-    AlgorithmRegistrar::getAlgorithmRegistrar().clear();
-    // dlclose
-     for(auto handle : handles) {
-        if(dlclose(handle)) {
-            std::cerr << "Failed to close library: " << dlerror() << std::endl;
+    if(rv.trace) {
+        std::string trace_error = rv.trace->write(rv.trace_path);
+        if(trace_error != "") {
+            std::cerr << trace_error << std::endl;
             return EXIT_FAILURE;
         }
     }
 
-    return EXIT_SUCCESS;
-}
+    // the factories point into the plugins, so they must be gone before the plugins are closed
+    rv.algorithms.clear();
+    std::string unload_error = loader.unload();
+    if(unload_error != "") {
+        std::cerr << unload_error << std::endl;
+        return EXIT_FAILURE;
+    }
 
+    return EXIT_SUCCESS;
+}
\ No newline at end of file